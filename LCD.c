@@ -42,6 +42,9 @@
 
 #include "cmsis_os.h"                   // CMSIS RTOS header file
 #include "stm32f0xx.h"                  // Device header
+#include "prof.h"
+#include "timebase.h"
+#include "pinmap.h"
 #include <stdio.h>
 
 // stm32f070x6.h
@@ -49,25 +52,13 @@
  *       'LCD_Thread': LCD Display thread
  *---------------------------------------------------------------------------*/
 
-/// LCD pinout definitions
-//RS - Register select pin
-#define LCD_RSPORT     GPIOB
-#define LCD_RSPINn     1
-//E - Enable pin
-#define LCD_EPORT      GPIOA
-#define LCD_EPINn      4
-//D4 - Data 4 pin
-#define LCD_D4PORT     GPIOA
-#define LCD_D4PINn     3
-//D5 - Data 5 pin
-#define LCD_D5PORT     GPIOA
-#define LCD_D5PINn     2
-//D6 - Data 6 pin
-#define LCD_D6PORT     GPIOA
-#define LCD_D6PINn     1
-//D7 - Data 7 pin
-#define LCD_D7PORT     GPIOA
-#define LCD_D7PINn     0
+/// LCD pinout, pin numbers in pinmap.h
+#define LCD_RSPORT     GPIO_PORT(LCD_RSPORTn)
+#define LCD_EPORT      GPIO_PORT(LCD_EPORTn)
+#define LCD_D4PORT     GPIO_PORT(LCD_D4PORTn)
+#define LCD_D5PORT     GPIO_PORT(LCD_D5PORTn)
+#define LCD_D6PORT     GPIO_PORT(LCD_D6PORTn)
+#define LCD_D7PORT     GPIO_PORT(LCD_D7PORTn)
 
 #define LCD_RSPIN		((uint16_t)(1U<<LCD_RSPINn))
 #define LCD_EPIN		((uint16_t)(1U<<LCD_EPINn))
@@ -80,7 +71,7 @@ void LCD_Init(uint8_t cols, uint8_t rows);
 void LCD_DisplayOn(void);
 void LCD_DisplayOff(void);
 void LCD_Clear(void);
-void LCD_Puts(uint8_t x, uint8_t y, char* str);
+void LCD_Puts(uint8_t x, uint8_t y, const char *str);
 void LCD_BlinkOn(void);
 void LCD_BlinkOff(void);
 void LCD_CursorOn(void);
@@ -88,6 +79,7 @@ void LCD_CursorOff(void);
 void LCD_ScrollLeft(void);
 void LCD_ScrollRight(void);
 void LCD_CreateChar(uint8_t location, uint8_t* data);
+void LCD_SetCharRows(uint8_t location, uint8_t row, uint8_t n, const uint8_t *data);
 void LCD_PutCustom(uint8_t x, uint8_t y, uint8_t location);
 
 extern uint32_t SystemCoreClock;
@@ -114,7 +106,7 @@ static void LCD_CursorSet(uint8_t col, uint8_t row);
 /* Private variable */
 static LCD_Options_t LCD_Opts;
 
-static void LCD_Delay(uint32_t us);
+static void LCD_Wait(uint32_t ms);
 
 /* Pin definitions */ 
 #define LCD_RS_LOW              LCD_RSPORT->BSRR = LCD_RSPIN<<16
@@ -122,7 +114,10 @@ static void LCD_Delay(uint32_t us);
 #define LCD_E_LOW               LCD_EPORT->BSRR = LCD_EPIN<<16
 #define LCD_E_HIGH              LCD_EPORT->BSRR = LCD_EPIN
 
-#define LCD_E_BLINK             LCD_E_HIGH; LCD_Delay(20); LCD_E_LOW; LCD_Delay(20)
+#define LCD_E_BLINK             LCD_E_HIGH; Tb_DelayUs(20); LCD_E_LOW; Tb_DelayUs(20)
+
+/* Power-up to first command, ms */
+#define LCD_POWERUP_MS          45
 
 /* Commands*/
 #define LCD_CLEARDISPLAY        0x01
@@ -161,74 +156,39 @@ static void LCD_Delay(uint32_t us);
 
 static void LCD_InitPins(void)
 {
-  RCC->AHBENR |= RCC_AHBENR_GPIOAEN;  /* Enable GPIOA clock         */
-  RCC->AHBENR |= RCC_AHBENR_GPIOBEN;  /* Enable GPIOB clock         */
+	static const gpio_cfg_t pa = GPIO_CFG(LCD_PINMAP, GPIO_PA);
+	static const gpio_cfg_t pb = GPIO_CFG(LCD_PINMAP, GPIO_PB);
 
 	/* All pins push-pull, no pullup */
-
-	LCD_RSPORT->MODER   &= ~(3ul << 2*LCD_RSPINn);
-  LCD_RSPORT->MODER   |=  (1ul << 2*LCD_RSPINn);
-  LCD_RSPORT->OTYPER  &= ~(1ul <<   LCD_RSPINn);
-  LCD_RSPORT->OSPEEDR &= ~(3ul << 2*LCD_RSPINn);
-  LCD_RSPORT->OSPEEDR |=  (1ul << 2*LCD_RSPINn);
-  LCD_RSPORT->PUPDR   &= ~(3ul << 2*LCD_RSPINn);
-
-	LCD_EPORT->MODER   &= ~(3ul << 2*LCD_EPINn);
-  LCD_EPORT->MODER   |=  (1ul << 2*LCD_EPINn);
-  LCD_EPORT->OTYPER  &= ~(1ul <<   LCD_EPINn);
-  LCD_EPORT->OSPEEDR &= ~(3ul << 2*LCD_EPINn);
-  LCD_EPORT->OSPEEDR |=  (1ul << 2*LCD_EPINn);
-  LCD_EPORT->PUPDR   &= ~(3ul << 2*LCD_EPINn);
-
-	LCD_D4PORT->MODER   &= ~(3ul << 2*LCD_D4PINn);
-  LCD_D4PORT->MODER   |=  (1ul << 2*LCD_D4PINn);
-  LCD_D4PORT->OTYPER  &= ~(1ul <<   LCD_D4PINn);
-  LCD_D4PORT->OSPEEDR &= ~(3ul << 2*LCD_D4PINn);
-  LCD_D4PORT->OSPEEDR |=  (1ul << 2*LCD_D4PINn);
-  LCD_D4PORT->PUPDR   &= ~(3ul << 2*LCD_D4PINn);
-
-	LCD_D5PORT->MODER   &= ~(3ul << 2*LCD_D5PINn);
-  LCD_D5PORT->MODER   |=  (1ul << 2*LCD_D5PINn);
-  LCD_D5PORT->OTYPER  &= ~(1ul <<   LCD_D5PINn);
-  LCD_D5PORT->OSPEEDR &= ~(3ul << 2*LCD_D5PINn);
-  LCD_D5PORT->OSPEEDR |=  (1ul << 2*LCD_D5PINn);
-  LCD_D5PORT->PUPDR   &= ~(3ul << 2*LCD_D5PINn);
-
-	LCD_D6PORT->MODER   &= ~(3ul << 2*LCD_D6PINn);
-  LCD_D6PORT->MODER   |=  (1ul << 2*LCD_D6PINn);
-  LCD_D6PORT->OTYPER  &= ~(1ul <<   LCD_D6PINn);
-  LCD_D6PORT->OSPEEDR &= ~(3ul << 2*LCD_D6PINn);
-  LCD_D6PORT->OSPEEDR |=  (1ul << 2*LCD_D6PINn);
-  LCD_D6PORT->PUPDR   &= ~(3ul << 2*LCD_D6PINn);
-
-	LCD_D7PORT->MODER   &= ~(3ul << 2*LCD_D7PINn);
-  LCD_D7PORT->MODER   |=  (1ul << 2*LCD_D7PINn);
-  LCD_D7PORT->OTYPER  &= ~(1ul <<   LCD_D7PINn);
-  LCD_D7PORT->OSPEEDR &= ~(3ul << 2*LCD_D7PINn);
-  LCD_D7PORT->OSPEEDR |=  (1ul << 2*LCD_D7PINn);
-  LCD_D7PORT->PUPDR   &= ~(3ul << 2*LCD_D7PINn);
-
+	RCC->AHBENR |= GPIO_CLOCKS(LCD_PINMAP);
+	Gpio_Config(GPIOA, &pa);
+	Gpio_Config(GPIOB, &pb);
 }
 
 
-static void LCD_Delay(uint32_t us)
+/**
+  * Millisecond wait: the kernel delay in threads, the timebase before
+  * osKernelStart(), when LCD_Init() runs from main()
+  */
+static void LCD_Wait(uint32_t ms)
 {
-	us *= 48; 
-	
-	while (us--) 
-		__nop();
-	
+	if (osKernelRunning())
+		osDelay(ms);
+	else
+		Tb_DelayUs(ms * 1000);
 }
 
 
 void LCD_Init(uint8_t cols, uint8_t rows) {
+	uint32_t t;
 	
 	LCD_Opts.Initialized = 0;
 	/* Init pinout */
 	LCD_InitPins();
 	
-	/* At least 40ms */
-	osDelay(45);
+	/* At least 40ms after power-up; the timebase started at reset */
+	t = Tb_Us() / 1000;
+	if (t < LCD_POWERUP_MS) LCD_Wait(LCD_POWERUP_MS - t);
 	
 	/* Set LCD width and height */
 	LCD_Opts.Rows = rows;
@@ -245,19 +205,19 @@ void LCD_Init(uint8_t cols, uint8_t rows) {
 	
 	/* Try to set 4bit mode */
 	LCD_Cmd4bit(0x03);
-	osDelay(5);
+	LCD_Wait(5);
 	
 	/* Second try */
 	LCD_Cmd4bit(0x03);
-		osDelay(5);
+		LCD_Wait(5);
 	
 	/* Third goo! */
 	LCD_Cmd4bit(0x03);
-		osDelay(5);
+		LCD_Wait(5);
 	
 	/* Set 4-bit interface */
 	LCD_Cmd4bit(0x02);
-	osDelay(1);
+	LCD_Wait(1);
 	
 	/* Set # lines, font size, etc. */
 	LCD_Cmd(LCD_FUNCTIONSET | LCD_Opts.DisplayFunction);
@@ -274,7 +234,7 @@ void LCD_Init(uint8_t cols, uint8_t rows) {
 	LCD_Cmd(LCD_ENTRYMODESET | LCD_Opts.DisplayMode);
 
 	/* Delay */
-		osDelay(5);
+		LCD_Wait(5);
 	
 	LCD_Opts.Initialized = 1;
 
@@ -289,11 +249,11 @@ uint8_t HD4478_initialized(void)
 
 void LCD_Clear(void) {
 	LCD_Cmd(LCD_CLEARDISPLAY);
-	//LCD_Delay(3000);
-	osDelay(3);
+	LCD_Wait(3);
 }
 
-void LCD_Puts(uint8_t x, uint8_t y, char* str) {
+void LCD_Puts(uint8_t x, uint8_t y, const char *str) {
+	PROF_START(PROF_LCD_PUTS);
 	LCD_CursorSet(x, y);
 	while (*str) {
 		if (LCD_Opts.currentX >= LCD_Opts.Cols) {
@@ -312,6 +272,7 @@ void LCD_Puts(uint8_t x, uint8_t y, char* str) {
 		}
 		str++;
 	}
+	PROF_STOP(PROF_LCD_PUTS);
 }
 
 void LCD_DisplayOn(void) {
@@ -353,13 +314,18 @@ void LCD_ScrollRight(void) {
 }
 
 void LCD_CreateChar(uint8_t location, uint8_t *data) {
-	uint8_t i;
+	LCD_SetCharRows(location, 0, 8, data);
+}
+
+/* Rows row .. row + n - 1 of a custom character, top row 0; the CGRAM
+   address counts up from the one command */
+void LCD_SetCharRows(uint8_t location, uint8_t row, uint8_t n, const uint8_t *data) {
 	/* We have 8 locations available for custom characters */
 	location &= 0x07;
-	LCD_Cmd(LCD_SETCGRAMADDR | (location << 3));
+	LCD_Cmd(LCD_SETCGRAMADDR | (location << 3) | (row & 0x07));
 	
-	for (i = 0; i < 8; i++) {
-		LCD_Data(data[i]);
+	while (n--) {
+		LCD_Data(*data++);
 	}
 }
 
@@ -37,7 +37,17 @@
 
 #include "cmsis_os.h"                   // CMSIS RTOS header file
 #include "stm32f0xx.h"                  // Device header
-#include "AD7715.h"
+#include "ad7715.h"
+#include "titration.h"
+#include "prof.h"
+#include "trace.h"
+#include "stkmon.h"
+#include "timebase.h"
+#include "cpuload.h"
+#include "pinmap.h"
+#include "hum.h"
+#include "rtmon.h"
+#include "stats.h"
 #include <string.h>
 
 /*----------------------------------------------------------------------------
@@ -45,21 +55,11 @@
  *---------------------------------------------------------------------------*/
  
 
-/* CLK: PA5 */
-#define AD7715_CLKPORT		GPIOA
-#define AD7715_CLKPINn		5
-
-/* MOSI: PA7 */
-#define AD7715_MOSIPORT		GPIOA
-#define AD7715_MOSIPINn   7
-
-/* MISO: PA6 */
-#define AD7715_MISOPORT		GPIOA
-#define AD7715_MISOPINn 	6
-
-/* CS: PF1 */
-#define AD7715_CSPORT		  GPIOF
-#define AD7715_CSPINn			1
+/* Pin numbers in pinmap.h */
+#define AD7715_CLKPORT		GPIO_PORT(AD7715_CLKPORTn)
+#define AD7715_MOSIPORT		GPIO_PORT(AD7715_MOSIPORTn)
+#define AD7715_MISOPORT		GPIO_PORT(AD7715_MISOPORTn)
+#define AD7715_CSPORT		  GPIO_PORT(AD7715_CSPORTn)
 
 
 /*----------------------------------------------------------------------------
@@ -70,67 +70,199 @@
 #define AD7715_MOSIPIN		((uint16_t)(1U<<AD7715_MOSIPINn))  
 #define AD7715_MISOPIN		((uint16_t)(1U<<AD7715_MISOPINn))  
 #define AD7715_CSPIN			((uint16_t)(1U<<AD7715_CSPINn))  
-#define AD7715_CLKPIN			((uint16_t)(1U<<AD7715_CLKPINn)) 
+#define AD7715_CLKPIN			((uint16_t)(1U<<AD7715_CLKPINn))
+
+/** Acquisition timer, 1 us counts; its interrupt polls DRDY */
+#define AD7715_TIM				TIM14
+#define AD7715_TIM_IRQn		TIM14_IRQn
+
+/** Thread signals */
+#define AD7715_SIG_BLOCK	0x01							// a block of conversions is ready
+#define AD7715_SIG_RATE		0x02							// AD7715_SetRate()
+
+/** SCLK high and low time, t4 and t5 of the data sheet */
+#define AD7715_SCLK_NS		100 
 
 
 
 /** Thread definitions */
 void AD7715_Thread (void const *argument);                             // thread function
 osThreadId AD7715_tid_Thread;                                          // thread id
-osThreadDef (AD7715_Thread, osPriorityNormal, 1, 0);                   // thread object
+osThreadDef (AD7715_Thread, RT_PRIO_ACQ, 1, 440);                      // thread object
 
 
 /** Local variables */
-static 	uint16_t adcreadout;
+static uint32_t adcreadout;                         // averaged conversions, Q16.8
+static ad7715_avg_t filt;                           // AD7715_Average() state
+static uint32_t sample_us;                          // Tb_Us() of the last conversion read
+static uint32_t settled_us;                         // Tb_Us() of the first settled readout, 0 before
+static uint32_t sclk_loops;                         // Tb_Spin() for AD7715_SCLK_NS
+static volatile uint8_t req_fs = AD7715_FS_50HZ;    // requested output rate
+static uint8_t mains_fs = AD7715_FS_50HZ;           // notch picked by the hum check
+
+/** DRDY poll period per output rate, us: half a conversion, so none is 
+    missed. Conversions per block: the thread wakes every 17 to 32 ms. */
+static const uint16_t poll_us[4] = { 10000, 8333, 2000, 1000 };
+static const uint8_t blk_n[4] = { 1, 1, (AD7715_BLOCK_N + 1) / 2, AD7715_BLOCK_N };
+
+/** Blocks, double buffered: the interrupt fills blk[blk_fill], the 
+    thread processes the other one */
+static uint16_t blk[2][AD7715_BLOCK_N];             // conversions
+static uint16_t blk_t[2][AD7715_BLOCK_N];           // their Tb_Us(), low half
+static uint32_t blk_us;                             // Tb_Us() of the last conversion of a block
+static volatile uint8_t blk_len;                    // conversions per block
+static uint8_t blk_got;                             // conversions in the block handed over
+static uint8_t blk_fill, blk_i;                     // buffer and index the interrupt writes
+static volatile uint8_t blk_done, blk_taken;        // blocks handed over and processed
+static volatile uint16_t blk_overruns;              // blocks dropped, the thread was late
 
 
 /**
-  Return last ADC readout 
+  Return last ADC readout, rounded to whole codes
 	*/
 uint16_t AD7715_Readout(void)
+{
+	uint32_t r = (adcreadout + (1UL << (AD7715_FRAC - 1))) >> AD7715_FRAC;
+
+	return (r > 0xFFFF) ? 0xFFFF : (uint16_t)r;
+}
+
+
+/**
+  Return last ADC readout with AD7715_FRAC fraction bits
+	*/
+uint32_t AD7715_ReadoutQ8(void)
 {
 	return adcreadout;
 }
+
+
+/**
+  Noise of the readout (one sigma), codes Q16.8: the conversion noise
+	divided by the square root of the conversions the average spans, n 
+	while they are summed and 2 * AD7715_AVG_N - 1 after.
+	*/
+uint16_t AD7715_NoiseQ8(void)
+{
+	uint32_t n = filt.n, x, r = 0, b = 1UL << 30;
+
+	if (n == 0) return 0xFFFF;
+	if (n >= AD7715_AVG_N) n = 2 * AD7715_AVG_N - 1;
+	x = filt.var / n;
+
+	/* integer square root, Q16 -> Q8 */
+	while (b > x) b >>= 2;
+	while (b)
+	{
+		if (x >= r + b)
+		{
+			x -= r + b;
+			r = (r >> 1) + b;
+		}
+		else r >>= 1;
+		b >>= 2;
+	}
+	return (r > 0xFFFF) ? 0xFFFF : (uint16_t)r;
+}
+
+
+/**
+  Timestamp of the last conversion, Tb_Us()
+	*/
+uint32_t AD7715_SampleTime(void)
+{
+	return sample_us;
+}
+
+
+/**
+  Timestamp of the first settled readout, Tb_Us(); 0 until then
+	*/
+uint32_t AD7715_SettledTime(void)
+{
+	return settled_us;
+}
 	
 
+/**
+  Output rate whose notch matches the mains, AD7715_FS_50HZ or _60HZ
+	*/
+uint8_t AD7715_MainsRate(void)
+{
+	return mains_fs;
+}
+
+
+/**
+  Request new output update rate (AD7715_FS_xxx). The thread reprograms 
+	the setup register before the next conversion is read.
+	*/
+void AD7715_SetRate(uint8_t fs)
+{
+	req_fs = fs & 0x03;
+	if (AD7715_tid_Thread) osSignalSet(AD7715_tid_Thread, AD7715_SIG_RATE);
+}
+
+
+/**
+  Blocks dropped because the thread had not processed the previous one
+	*/
+uint16_t AD7715_Overruns(void)
+{
+	return blk_overruns;
+}
+
+
+/**
+  Average of the conversions, Q16.8. The first AD7715_AVG_N are summed, so
+	the output is their mean from the first one on, and then the running
+	average with the new sample weighted 1/64 starts from that mean. The
+	fraction bits keep what averaging gains over a single conversion.
+	
+	Also tracks the conversion noise: the squared distance of each
+	conversion from the average, itself averaged the same way. Distances
+	over 128 codes (a step, not noise) are clipped.
+	*/
+uint32_t AD7715_Average(ad7715_avg_t *f, uint16_t rd)
+{
+	uint32_t x = (uint32_t)rd << AD7715_FRAC;
+	int32_t d;
+
+	if (f->n < AD7715_AVG_N)
+	{
+		f->acc += x;
+		f->n++;
+		d = (int32_t)(x - (f->acc + f->n / 2) / f->n);
+		if (f->n == AD7715_AVG_N) f->acc = (f->acc + AD7715_AVG_N / 2) / AD7715_AVG_N;
+	}
+	else
+	{
+		f->acc = ((AD7715_AVG_N - 1) * f->acc + x + AD7715_AVG_N / 2) / AD7715_AVG_N;
+		d = (int32_t)(x - f->acc);
+	}
+	if (d > 0x7FFF) d = 0x7FFF;
+	if (d < -0x7FFF) d = -0x7FFF;
+	f->var = (uint32_t)((int32_t)f->var + ((d * d - (int32_t)f->var) / (int32_t)f->n));
+
+	return (f->n < AD7715_AVG_N) ? (f->acc + f->n / 2) / f->n : f->acc;
+}
+
+
 /** 
   Init AD7715 pins 
 */
 void AD7715_InitPins(void)
 {
-  RCC->AHBENR |= RCC_AHBENR_GPIOAEN;  /* Enable GPIOA clock         */
-  RCC->AHBENR |= RCC_AHBENR_GPIOFEN;  /* Enable GPIOF clock         */
-
-	/* CLK push-pull, no pullup */
-	AD7715_CLKPORT->MODER   &= ~(3ul << 2*AD7715_CLKPINn);
-  AD7715_CLKPORT->MODER   |=  (1ul << 2*AD7715_CLKPINn);
-  AD7715_CLKPORT->OTYPER  &= ~(1ul <<   AD7715_CLKPINn);
-  AD7715_CLKPORT->OSPEEDR &= ~(3ul << 2*AD7715_CLKPINn);
-  AD7715_CLKPORT->OSPEEDR |=  (1ul << 2*AD7715_CLKPINn);
-  AD7715_CLKPORT->PUPDR   &= ~(3ul << 2*AD7715_CLKPINn);
-
-	/* MOSI push-pull, no pullup */
-	AD7715_MOSIPORT->MODER   &= ~(3ul << 2*AD7715_MOSIPINn);
-  AD7715_MOSIPORT->MODER   |=  (1ul << 2*AD7715_MOSIPINn);
-  AD7715_MOSIPORT->OTYPER  &= ~(1ul <<   AD7715_MOSIPINn);
-  AD7715_MOSIPORT->OSPEEDR &= ~(3ul << 2*AD7715_MOSIPINn);
-  AD7715_MOSIPORT->OSPEEDR |=  (1ul << 2*AD7715_MOSIPINn);
-  AD7715_MOSIPORT->PUPDR   &= ~(3ul << 2*AD7715_MOSIPINn);
-
-	/* CS push-pull, no pullup */
-	AD7715_CSPORT->MODER   &= ~(3ul << 2*AD7715_CSPINn);
-  AD7715_CSPORT->MODER   |=  (1ul << 2*AD7715_CSPINn);
-  AD7715_CSPORT->OTYPER  &= ~(1ul <<   AD7715_CSPINn);
-  AD7715_CSPORT->OSPEEDR &= ~(3ul << 2*AD7715_CSPINn);
-  AD7715_CSPORT->OSPEEDR |=  (1ul << 2*AD7715_CSPINn);
-  AD7715_CSPORT->PUPDR   &= ~(3ul << 2*AD7715_CSPINn);
-	
-	/* MISO Input, pullup */
-  AD7715_MISOPORT->MODER   &= ~(3ul << 2*AD7715_MISOPINn);
-  AD7715_MISOPORT->OSPEEDR &= ~(3ul << 2*AD7715_MISOPINn);
-  AD7715_MISOPORT->OSPEEDR |=  (1ul << 2*AD7715_MISOPINn);
-  AD7715_MISOPORT->PUPDR   &= ~(3ul << 2*AD7715_MISOPINn);
-	AD7715_MISOPORT->PUPDR   |=  (1ul << 2*AD7715_MISOPINn);
+	static const gpio_cfg_t pa = GPIO_CFG(AD7715_PINMAP, GPIO_PA);
+	static const gpio_cfg_t pf = GPIO_CFG(AD7715_PINMAP, GPIO_PF);
+
+	RCC->AHBENR |= GPIO_CLOCKS(AD7715_PINMAP);
+
+	sclk_loops = Tb_NsLoops(AD7715_SCLK_NS);
+
+	/* CLK, MOSI, CS push-pull, no pullup; MISO input, pullup */
+	Gpio_Config(GPIOA, &pa);
+	Gpio_Config(GPIOF, &pf);
 
 	AD7715_CLKPORT->BSRR = AD7715_CLKPIN;    // CLK = 1
 	AD7715_CSPORT->BSRR = AD7715_CSPIN;      // CS = 1
@@ -167,15 +299,11 @@ void AD7715_SetCS(int state)
   */
 void AD7715_SetCLK(int state)
 {
-	int i;
-	
-	for (i=0; i<8; i++) 
-  {
-		if (state) 
-			AD7715_CLKPORT->BSRR = AD7715_CLKPIN;
-		else
-			AD7715_CLKPORT->BSRR = AD7715_CLKPIN << 16;	
-	}
+	if (state) 
+		AD7715_CLKPORT->BSRR = AD7715_CLKPIN;
+	else
+		AD7715_CLKPORT->BSRR = AD7715_CLKPIN << 16;	
+	Tb_Spin(sclk_loops);
 }
 
 
@@ -248,6 +376,142 @@ uint8_t AD7715_transferbyte(uint8_t byte_out)
 }	
 
 
+/**
+  * Communications register value that reads register rs
+  */
+static uint8_t AD7715_ReadCmd(uint8_t rs)
+{
+	AD7715_CommReg_t CommReg;
+
+	CommReg.b.DRDY = 0;
+	CommReg.b.Zero = 0;
+	CommReg.b.RS = rs;
+	CommReg.b.RW = AD7715_RW_READ;
+	CommReg.b.STBY = AD7715_STBY_POWERUP;
+	CommReg.b.Gain = AD7715_GAIN_2;
+
+	return CommReg.B;
+}
+
+
+/**
+  * Write the setup register; gain 2 as in every communications write, a
+  * gain change would restart the filter
+  */
+static void AD7715_WriteSetup(uint8_t setup)
+{
+	AD7715_CommReg_t CommReg;
+
+	CommReg.b.DRDY = 0;
+	CommReg.b.Zero = 0;
+	CommReg.b.RS = AD7715_REG_SETUP;
+	CommReg.b.RW = AD7715_RW_WRITE;
+	CommReg.b.STBY = AD7715_STBY_POWERUP;
+	CommReg.b.Gain = AD7715_GAIN_2;
+
+	AD7715_SetCS(0);
+	AD7715_transferbyte(CommReg.B);
+	AD7715_transferbyte(setup);
+	AD7715_SetCS(1);
+}
+
+
+/**
+  * Acquisition timer: clock, 1 us counts, interrupt below the encoder
+  */
+static void AD7715_AcqInit(void)
+{
+	RCC->APB1ENR |= RCC_APB1ENR_TIM14EN;
+
+	AD7715_TIM->CR1 = TIM_CR1_URS;         // only overflow sets UIF
+	AD7715_TIM->PSC = SystemCoreClock / 1000000UL - 1;
+	AD7715_TIM->EGR = TIM_EGR_UG;          // load prescaler
+	AD7715_TIM->SR = 0;
+
+	NVIC_SetPriority(AD7715_TIM_IRQn, 3);
+	NVIC_EnableIRQ(AD7715_TIM_IRQn);
+}
+
+
+/**
+  * Start polling at output rate fs, with an empty block. A block is due
+  * before the next one is full.
+  */
+static void AD7715_AcqStart(uint8_t fs)
+{
+	Rt_Declare(RT_JOB_ACQ, 2UL * poll_us[fs] * blk_n[fs], 2UL * poll_us[fs] * blk_n[fs]);
+	blk_len = blk_n[fs];
+	blk_i = 0;
+	AD7715_TIM->ARR = poll_us[fs] - 1;
+	AD7715_TIM->CNT = 0;
+	AD7715_TIM->SR = 0;
+	AD7715_TIM->DIER = TIM_DIER_UIE;
+	AD7715_TIM->CR1 = TIM_CR1_URS | TIM_CR1_CEN;
+}
+
+
+/**
+  * Stop polling, so the thread owns the SPI; the partial block is dropped
+  */
+static void AD7715_AcqStop(void)
+{
+	AD7715_TIM->CR1 = TIM_CR1_URS;
+	AD7715_TIM->DIER = 0;
+	AD7715_TIM->SR = 0;
+	NVIC_ClearPendingIRQ(AD7715_TIM_IRQn);
+	blk_taken = blk_done;
+}
+
+
+/**
+  * Poll DRDY and read a new conversion into the block. A full block goes
+  * to the thread, unless it still has the other one; then this one is
+  * dropped and counted.
+  */
+void TIM14_IRQHandler(void)
+{
+	uint8_t adcbuf[2];
+	AD7715_CommReg_t CommReg;
+	uint16_t rd;
+	uint32_t now;
+
+	AD7715_TIM->SR = ~TIM_SR_UIF;
+
+	/** Read from comm register, poll DRDY */
+	AD7715_SetCS(0);
+	AD7715_transferbyte(AD7715_ReadCmd(AD7715_REG_COMM));
+	CommReg.B = AD7715_transferbyte(0xff);
+	AD7715_SetCS(1);
+	if (CommReg.b.DRDY) return;
+
+	/** read data */
+	AD7715_SetCS(0);
+	AD7715_transferbyte(AD7715_ReadCmd(AD7715_REG_DATA));
+	adcbuf[1] = AD7715_transferbyte(0xff);
+	adcbuf[0] = AD7715_transferbyte(0xff);
+	AD7715_SetCS(1);
+	memcpy(&rd, adcbuf, 2);
+	now = Tb_Us();
+
+	blk[blk_fill][blk_i] = rd;
+	blk_t[blk_fill][blk_i] = (uint16_t)now;
+	if (++blk_i < blk_len) return;
+
+	if (blk_taken != blk_done)
+	{
+		blk_overruns++;
+		blk_i = 0;
+		return;
+	}
+	blk_us = now;
+	blk_got = blk_i;
+	blk_i = 0;
+	blk_fill ^= 1;
+	blk_done++;
+	osSignalSet(AD7715_tid_Thread, AD7715_SIG_BLOCK);
+}
+
+
 /**
   * Init AD7715 thread 
   */
@@ -262,97 +526,120 @@ int Init_AD7715_Thread (void) {
 
 /**
   * AD7715 Thread: perform continuous conversion, calculate calibrated values and 
-  * and store the values to buffer.
+  * and store the values to buffer. Conversions are read by TIM14_IRQHandler(),
+  * the thread wakes once per block of them.
   */
 void AD7715_Thread (void const *argument) 
 {
 
-	uint8_t adcbuf[2];
-	AD7715_CommReg_t CommReg; 
 	AD7715_SetupReg_t SetupReg; 
+	const uint16_t *b, *bt;
 	uint16_t rd;
-	uint32_t avg = 0;
+	hum_det_t det;
+	uint32_t hum_us = 0;
+	uint8_t hum = 1, skip = HUM_SKIP, recal = 1, i;
+	
+	Stk_Register(STK_AD7715, (osThread(AD7715_Thread))->stacksize);
 	
 	/* Init Pins */
 	AD7715_InitPins();
 	
 	/* Reset AD7715 */
 	AD7715_Reset();
+	AD7715_AcqInit();
 	
-	/** Write to setup register */
-	CommReg.b.DRDY = 0;
-	CommReg.b.Zero = 0;
-	CommReg.b.RS = AD7715_REG_SETUP;
-	CommReg.b.RW = AD7715_RW_WRITE;	
-	CommReg.b.STBY = AD7715_STBY_POWERUP;
-	CommReg.b.Gain = AD7715_GAIN_1; 
-
-  /** Setup register */
+  /** Setup register: hum check first, the self-calibration follows at 
+	    the rate it picks */
   SetupReg.b.BU = AD7715_BU_BIPOLAR;
 	SetupReg.b.BUF = AD7715_BUF_BYPASSED;
 	SetupReg.b.CLK = AD7715_CLK_2_4576MHZ;
-	SetupReg.b.FS = AD7715_FS_50HZ;
+	SetupReg.b.FS = HUM_FS;
 	SetupReg.b.FSYNC = 0;
-	SetupReg.b.MD = AD7715_MODE_SELFCAL;
-  
-	AD7715_SetCS(0);
-	AD7715_transferbyte(CommReg.B);
-	AD7715_transferbyte(SetupReg.B);
-	AD7715_SetCS(1);
-
-  osDelay(5);
-
-  /* Set normal operation */
- 	SetupReg.b.MD = AD7715_MODE_NORMAL;
-	
-	AD7715_SetCS(0);
-	AD7715_transferbyte(CommReg.B);
-	AD7715_transferbyte(SetupReg.B);
-	AD7715_SetCS(1);
+	SetupReg.b.MD = AD7715_MODE_NORMAL;
+	AD7715_WriteSetup(SetupReg.B);
+	Hum_Start(&det);
+	AD7715_AcqStart(HUM_FS);
 
 	
   while (1) {
 		
-		/** Read from comm register, poll DRDY */
-		CommReg.b.DRDY = 0;
-		CommReg.b.Zero = 0;
-		CommReg.b.RS = AD7715_REG_COMM;
-		CommReg.b.RW = AD7715_RW_READ;	
-		CommReg.b.STBY = AD7715_STBY_POWERUP;
-		CommReg.b.Gain = AD7715_GAIN_2; 
+		Load_Block(LOAD_AD7715);
+		osSignalWait(0, osWaitForever);                             // sleep until a block or a rate request
+		Load_Run(LOAD_AD7715);
 		
-		AD7715_SetCS(0);
-		AD7715_transferbyte(CommReg.B);
-		CommReg.B = AD7715_transferbyte(0xff);
-		AD7715_SetCS(1);
-		
-		if ((CommReg.b.DRDY) == 0) 
+		/** Process the block, conversion by conversion as they were read */
+		if (blk_taken != blk_done)
 		{
-			// read data
-			CommReg.b.DRDY = 0;
-			CommReg.b.Zero = 0;
-			CommReg.b.RS = AD7715_REG_DATA;
-			CommReg.b.RW = AD7715_RW_READ;	
-			CommReg.b.STBY = AD7715_STBY_POWERUP;
-			CommReg.b.Gain = AD7715_GAIN_2;
-
-			AD7715_SetCS(0);
-			AD7715_transferbyte(CommReg.B);
-			adcbuf[1] = AD7715_transferbyte(0xff);
-			adcbuf[0] = AD7715_transferbyte(0xff);
-			AD7715_SetCS(1); 
-			memcpy(&rd, adcbuf, 2);
-			
-			avg = 63 * avg + (uint32_t)rd;
-			avg = avg / 64;
-			
-			adcreadout = (uint16_t)avg;
-			
-			//memcpy(&adcreadout, adcbuf, 2);
+			PROF_START(PROF_AD7715_SAMPLE);
+			Rt_Start(RT_JOB_ACQ, blk_us);
+			b = blk[blk_fill ^ 1];
+			bt = blk_t[blk_fill ^ 1];
+			for (i = 0; i < blk_got; i++)
+			{
+				rd = b[i];
+				sample_us = blk_us - (uint16_t)(bt[blk_got - 1] - bt[i]);
+				
+				if (hum)
+				{
+					// readout holds its last value during the check
+					if (skip) skip--;
+					else if (Hum_Sample(&det, rd))
+					{
+						mains_fs = Hum_Decide(&det, mains_fs);
+						recal |= Hum.changed;
+						if (!Titration_Active()) req_fs = mains_fs;
+						hum_us = sample_us;
+						hum = 0;
+						TRACE_EVT(TRC_HUM, (Hum.rejected_q8 > 0xFFFF) ? 0xFFFF : Hum.rejected_q8);
+						break;                                            // the rest is at the check rate
+					}
+				}
+				else
+				{
+					adcreadout = AD7715_Average(&filt, rd);
+					Stats_Sample(rd);
+					if ((settled_us == 0) && (filt.n >= AD7715_SETTLE_N))
+					{
+						settled_us = sample_us ? sample_us : 1;
+						TRACE_EVT(TRC_AD_SETTLED, settled_us / 1000);
+					}
+					
+					TRACE_EVT(TRC_AD_SAMPLE, rd);
+					if (Titration_Active()) Titration_Sample(rd);
+				}
+			}
+			blk_taken++;
+			Rt_End(RT_JOB_ACQ);
+			PROF_STOP(PROF_AD7715_SAMPLE);
 			
+			/* cut the block short to end with the check */
+			if (hum && (skip + HUM_N - det.n < blk_len)) blk_len = skip + HUM_N - det.n;
 		}
-			
 		
-    osThreadYield ();                                           // suspend thread
+		/** Change output rate if requested. Self-calibration takes 6 
+		    conversion periods and returns to normal mode by itself; the 
+		    first DRDY after it is the first valid result. */
+		if (!hum && ((req_fs != SetupReg.b.FS) || recal))
+		{
+			AD7715_AcqStop();
+			SetupReg.b.FS = req_fs;
+			SetupReg.b.MD = recal ? AD7715_MODE_SELFCAL : AD7715_MODE_NORMAL;
+			AD7715_WriteSetup(SetupReg.B);
+			SetupReg.b.MD = AD7715_MODE_NORMAL;
+			recal = 0;
+			AD7715_AcqStart(SetupReg.b.FS);
+		}
+		
+		/** Periodic hum check, not while a titration needs the samples */
+		if (!hum && !Titration_Active() && ((Tb_Us() - hum_us) >= HUM_PERIOD_S * 1000000UL))
+		{
+			AD7715_AcqStop();
+			SetupReg.b.FS = HUM_FS;
+			AD7715_WriteSetup(SetupReg.B);
+			Hum_Start(&det);
+			skip = HUM_SKIP;
+			hum = 1;
+			AD7715_AcqStart(HUM_FS);
+		}
   }
 }
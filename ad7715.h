@@ -125,7 +125,40 @@ typedef union
 	uint8_t B;
 } AD7715_SetupReg_t;
 
+/** \brief Conversions averaged with equal weight after start-up, then
+ *         the running average takes over with weight 1/AD7715_AVG_N */
+#define AD7715_AVG_N				64
+
+/** \brief Conversions after self-calibration before the readout counts as
+ *         settled */
+#define AD7715_SETTLE_N			4
+
+/** \brief Conversions per block at 500 Hz, half of it at 250 Hz; one at
+ *         50 and 60 Hz. 1 wakes the thread for every conversion. */
+#ifndef AD7715_BLOCK_N
+#define AD7715_BLOCK_N			16
+#endif
+
+/** \brief Fraction bits of the averaged readout, Q16.8 ADC codes */
+#define AD7715_FRAC					8
+
+/** \brief Averaging filter state */
+typedef struct
+{
+	uint32_t acc;						/*!< sum of n conversions, then the running average, Q16.8 */
+	uint32_t var;						/*!< conversion noise variance, codes^2 Q16 */
+	uint8_t n;							/*!< conversions so far, up to AD7715_AVG_N */
+} ad7715_avg_t;
+
 uint16_t AD7715_Readout(void);
+uint32_t AD7715_ReadoutQ8(void);
+uint16_t AD7715_NoiseQ8(void);
+uint32_t AD7715_SampleTime(void);
+uint32_t AD7715_SettledTime(void);
+uint8_t AD7715_MainsRate(void);
+void AD7715_SetRate(uint8_t fs);
+uint16_t AD7715_Overruns(void);
+uint32_t AD7715_Average(ad7715_avg_t *f, uint16_t rd);
 
 #endif 
 
@@ -0,0 +1,248 @@
+/**
+  ******************************************************************************
+  * @file    calib.c
+  * @author  e.pavlin.si
+  * @brief   Double buffered calibration table
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * The active slot is Cal_Slot[Cal_Seq & 1]. A writer fills the inactive
+  * slot and then increments Cal_Seq, so the new table appears in one step.
+  * A slot can only be overwritten after it was made inactive by another
+  * increment, therefore a reader that sees the same Cal_Seq before and
+  * after its computation used a consistent table. Otherwise it retries.
+  *
+  * Writers (the calibration menu) are serialized by a mutex. Readers never
+  * wait. Cal_Init() runs before osKernelStart(), alone, and publishes
+  * without it.
+  *
+  */
+
+#include "cmsis_os.h"                   // CMSIS RTOS header file
+#include "stm32f0xx.h"                  // Device header
+#include "calib.h"
+#include "ad7715.h"
+#include "tempcomp.h"
+
+
+/** Local variables */
+static cal_table_t Cal_Slot[2];
+static volatile uint32_t Cal_Seq;
+
+osMutexDef (Cal_Mutex);
+static osMutexId Cal_Mutex_id;
+
+
+/**
+  * Precompute segment coefficients into slot t
+  */
+static void Cal_Prepare(cal_table_t *t, const cal_points_t *pts)
+{
+	uint8_t s, i;
+	int32_t dx;
+
+	t->pts = *pts;
+	t->three = (pts->AD_point[2] != 0);
+	t->up_below = (pts->AD_point[2] < pts->AD_point[1]);
+
+	for (s = 0; s < 2; s++)
+	{
+		i = (s && t->three) ? 1 : 0;
+		t->x0[s] = pts->AD_point[i];
+		t->y0[s] = pts->refpoint[i];
+		dx = (int32_t)pts->AD_point[i + 1] - (int32_t)pts->AD_point[i];
+		if ((dx == 0) || (!t->three && s))
+		{
+			t->slope[s] = (dx == 0) ? 0 : t->slope[0];
+		}
+		else
+		{
+			t->slope[s] = (((int32_t)pts->refpoint[i + 1] - (int32_t)pts->refpoint[i]) * 65536L) / dx;
+		}
+	}
+}
+
+
+/**
+  * Fill inactive slot and publish it. Caller holds the mutex.
+  */
+static void Cal_Write(const cal_points_t *pts)
+{
+	uint32_t seq = Cal_Seq;
+
+	Cal_Prepare(&Cal_Slot[(seq + 1) & 1], pts);
+	__DMB();
+	Cal_Seq = seq + 1;
+}
+
+
+/**
+  * Factory default calibration
+  */
+static void Cal_Default(cal_points_t *pts)
+{
+	/* 2 point cal */
+	pts->AD_point[0] = 30610;  pts->refpoint[0] = 4000;
+	pts->AD_point[1] = 23940;  pts->refpoint[1] = 9000;
+	pts->AD_point[2] = 0;      pts->refpoint[2] = 0;
+	pts->t_c10 = TEMP_CAL_C10;
+}
+
+
+/**
+  * Before osKernelStart(): no other thread runs, and the mutex must not be
+  * waited for yet, so the default is written directly
+  */
+void Cal_Init(void)
+{
+	cal_points_t pts;
+
+	Cal_Mutex_id = osMutexCreate (osMutex (Cal_Mutex));
+	Cal_Default(&pts);
+	Cal_Write(&pts);
+}
+
+
+/**
+  * Back to the factory default, at runtime
+  */
+void Cal_LoadDefault(void)
+{
+	cal_points_t pts;
+
+	Cal_Default(&pts);
+	Cal_Publish(&pts);
+}
+
+
+/**
+  * Consistent copy of the current calibration points
+  */
+void Cal_Get(cal_points_t *pts)
+{
+	uint32_t seq;
+
+	do
+	{
+		seq = Cal_Seq;
+		__DMB();
+		*pts = Cal_Slot[seq & 1].pts;
+		__DMB();
+	} while (seq != Cal_Seq);
+}
+
+
+void Cal_Publish(const cal_points_t *pts)
+{
+	osMutexWait (Cal_Mutex_id, osWaitForever);
+	Cal_Write(pts);
+	osMutexRelease (Cal_Mutex_id);
+}
+
+
+/**
+  * Replace one calibration point, taken at t_c10 (0.1 deg C). npts selects
+  * 2 or 3 point calibration.
+  */
+void Cal_SetPoint(uint8_t npts, uint8_t idx, uint16_t ad, uint16_t ref, int16_t t_c10)
+{
+	cal_points_t pts;
+
+	if (idx >= npts) return;
+
+	osMutexWait (Cal_Mutex_id, osWaitForever);
+	pts = Cal_Slot[Cal_Seq & 1].pts;
+	pts.AD_point[idx] = ad;
+	pts.refpoint[idx] = ref;
+	pts.t_c10 = t_c10;
+	if (npts < 3)
+	{
+		pts.AD_point[2] = 0;
+		pts.refpoint[2] = 0;
+	}
+	Cal_Write(&pts);
+	osMutexRelease (Cal_Mutex_id);
+}
+
+
+/**
+  * Convert ADC code, Q16.8 (AD7715_FRAC), to pH (0.001 pH, not limited, 
+  * no temperature compensation). Lock free, safe from any thread.
+  */
+int32_t Cal_pH(uint32_t adc)
+{
+	const cal_table_t *c;
+	uint32_t seq;
+	uint8_t s;
+	int32_t y;
+
+	do
+	{
+		seq = Cal_Seq;
+		__DMB();
+		c = &Cal_Slot[seq & 1];
+		s = (c->three && ((adc < ((uint32_t)c->pts.AD_point[1] << AD7715_FRAC)) == c->up_below)) ? 1 : 0;
+		y = c->y0[s] + (int32_t)(((int64_t)c->slope[s] * ((int32_t)adc - (c->x0[s] << AD7715_FRAC))
+		                          + (1L << (15 + AD7715_FRAC))) >> (16 + AD7715_FRAC));
+		__DMB();
+	} while (seq != Cal_Seq);
+
+	return y;
+}
+
+
+/**
+  * Temperature the calibration was taken at, 0.1 deg C. Lock free.
+  */
+int16_t Cal_TempC10(void)
+{
+	uint32_t seq;
+	int16_t t;
+
+	do
+	{
+		seq = Cal_Seq;
+		__DMB();
+		t = Cal_Slot[seq & 1].pts.t_c10;
+		__DMB();
+	} while (seq != Cal_Seq);
+
+	return t;
+}
+
+
+/**
+  * Publication counter, changes whenever a new table is published
+  */
+uint32_t Cal_Sequence(void)
+{
+	return Cal_Seq;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file     calib.h
+ * @brief    Calibration table Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Calibration is published into one of two slots and selected by
+ *           a sequence counter. Cal_pH() takes no lock and never sees a
+ *           half-written table.
+ *
+ */
+
+#ifndef ___CALIB_H_
+#define ___CALIB_H_
+
+#include <stdint.h>
+
+/** \brief Calibration points as entered by the user */
+typedef struct
+{
+	uint16_t AD_point[3];				/*!< ADC codes, AD_point[2] = 0 for 2 point cal */
+  uint16_t refpoint[3]; 			/*!< reference pH, 0.001 pH */
+	int16_t t_c10;							/*!< temperature of the last point taken, 0.1 deg C */
+} cal_points_t;
+
+
+/** \brief Published calibration with precomputed segment coefficients */
+typedef struct
+{
+	cal_points_t pts;
+	int32_t slope[2];						/*!< 0.001 pH per ADC code, Q16 */
+	int32_t x0[2];							/*!< segment origin, ADC code */
+	int32_t y0[2];							/*!< pH at origin, 0.001 pH */
+	uint8_t three;							/*!< 3 point calibration */
+	uint8_t up_below;						/*!< upper segment lies below AD_point[1] */
+} cal_table_t;
+
+
+void Cal_Init(void);
+void Cal_LoadDefault(void);
+void Cal_Get(cal_points_t *pts);
+void Cal_Publish(const cal_points_t *pts);
+void Cal_SetPoint(uint8_t npts, uint8_t idx, uint16_t ad, uint16_t ref, int16_t t_c10);
+int32_t Cal_pH(uint32_t adc);
+int16_t Cal_TempC10(void);
+uint32_t Cal_Sequence(void);
+
+#endif
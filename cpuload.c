@@ -0,0 +1,149 @@
+/**
+  ******************************************************************************
+  * @file    cpuload.c
+  * @author  e.pavlin.si
+  * @brief   CPU utilization
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * Load_Idle() is called with interrupts masked, so it only adds. A
+  * thread's busy time is added by that thread and taken and cleared by
+  * Load_Update() in main; both sides mask interrupts, so no time is lost
+  * when one preempts the other. t0 is only written by its own thread.
+  *
+  */
+
+#include "stm32f0xx.h"                  // Device header
+#include "cpuload.h"
+#include "timebase.h"
+#include "fmt.h"
+
+/** Utilization, for the debugger */
+load_t Load;
+
+static const char * const load_names[LOAD_NTHREADS + 1] =
+{
+	"AD7715_Thread",
+	"Measure_Thread",
+	"main",
+	"osTimerThread",
+	"cpu"
+};
+
+
+/**
+  * Thread returned from a blocking call
+  */
+void Load_Run(uint8_t id)
+{
+	Load.th[id].t0 = Tb_Us();
+}
+
+
+/**
+  * Thread is about to block
+  */
+void Load_Block(uint8_t id)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t d = Tb_Us() - Load.th[id].t0;
+
+	__disable_irq();
+	Load.th[id].busy += d;
+	__set_PRIMASK(primask);
+}
+
+
+/**
+  * Time asleep in os_idle_demon()
+  */
+void Load_Idle(uint32_t us)
+{
+	Load.idle += us;
+}
+
+
+static uint16_t Load_Share(uint32_t us, uint32_t window)
+{
+	uint32_t p = (uint32_t)(((uint64_t)us * 1000) / window);
+
+	return (uint16_t)((p > 1000) ? 1000 : p);
+}
+
+
+/**
+  * Close the window and latch the shares
+  */
+void Load_Update(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t now, window, idle;
+	uint32_t busy[LOAD_NTHREADS];
+	uint8_t i;
+
+	__disable_irq();
+	now = Tb_Us();
+	window = now - Load.t_window;
+	if (window == 0)
+	{
+		__set_PRIMASK(primask);
+		return;
+	}
+	for (i = 0; i < LOAD_NTHREADS; i++)
+	{
+		busy[i] = Load.th[i].busy;
+		Load.th[i].busy = 0;
+	}
+	idle = Load.idle;
+	Load.idle = 0;
+	Load.t_window = now;
+	__set_PRIMASK(primask);
+
+	for (i = 0; i < LOAD_NTHREADS; i++) Load.th[i].pct = Load_Share(busy[i], window);
+	Load.idle_pct = Load_Share(idle, window);
+	Load.cpu_pct = (uint16_t)(1000 - Load.idle_pct);
+}
+
+
+/**
+  * "name share%" of the last window; id LOAD_NTHREADS for the whole CPU.
+  * dst holds LOAD_LINE_LEN characters.
+  */
+char *Load_Line(char *dst, uint8_t id)
+{
+	char *p, *e = dst + LOAD_LINE_LEN - 1;
+
+	p = Fmt_Str(dst, e, load_names[id], 16);
+	p = Fmt_Fixed(p, e, (id < LOAD_NTHREADS) ? Load.th[id].pct : Load.cpu_pct, 1, 6);
+	p = Fmt_Char(p, e, '%');
+	*p = 0;
+	return p;
+}
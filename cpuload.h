@@ -0,0 +1,69 @@
+/**
+ * @file     cpuload.h
+ * @brief    CPU utilization Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Idle time is what os_idle_demon() spends asleep in WFI, timed
+ *           with Tb_Us(). A thread's busy time runs from its return out of
+ *           a blocking call (Load_Run) to its next one (Load_Block). Every
+ *           thread is accounted: AD7715_Thread, Measure_Thread, the jobs
+ *           of the main loop and the scheduler tick in the RTX timer
+ *           thread; os_idle_demon is the idle time. RTX has no switch
+ *           hook, so a thread that is preempted while busy is charged
+ *           for the preempting time as well: Measure_Thread for the
+ *           blocks AD7715_Thread processes meanwhile. The bursts are
+ *           short, so this is small.
+ *
+ *           Load_Update() closes a window of about LOAD_WINDOW_MS and
+ *           latches the shares in 0.1 %. Results are in Load for the
+ *           debugger watch window, and Load_Line() formats them.
+ *
+ */
+
+#ifndef ___CPULOAD_H_
+#define ___CPULOAD_H_
+
+#include <stdint.h>
+
+/** \brief Accounted threads; Load_Line() takes LOAD_NTHREADS for the total */
+#define LOAD_AD7715					0
+#define LOAD_MEASURE				1
+#define LOAD_MAIN						2
+#define LOAD_TIMER					3
+#define LOAD_NTHREADS				4
+
+/** \brief Window, called from main(), and the deadline of the update */
+#define LOAD_WINDOW_MS			1000
+#define LOAD_DEADLINE_MS		100
+
+/** \brief Length of a Load_Line() result, with terminating zero */
+#define LOAD_LINE_LEN				32
+
+/** \brief One thread */
+typedef struct
+{
+	uint32_t busy;					/*!< us in the current window */
+	uint32_t t0;						/*!< Tb_Us() at Load_Run() */
+	uint16_t pct;						/*!< busy share of the last window, 0.1 % */
+} load_thread_t;
+
+/** \brief All of it */
+typedef struct
+{
+	load_thread_t th[LOAD_NTHREADS];
+	uint32_t idle;					/*!< us asleep in the current window */
+	uint32_t t_window;			/*!< Tb_Us() at window start */
+	uint16_t idle_pct;			/*!< idle share of the last window, 0.1 % */
+	uint16_t cpu_pct;				/*!< 1000 - idle_pct */
+} load_t;
+
+extern load_t Load;
+
+void Load_Run(uint8_t id);
+void Load_Block(uint8_t id);
+void Load_Idle(uint32_t us);
+void Load_Update(void);
+char *Load_Line(char *dst, uint8_t id);
+
+#endif
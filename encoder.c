@@ -2,6 +2,7 @@
 #include "RTE_Components.h"             // Component selection
 #include "cmsis_os.h"                   // ARM::CMSIS:RTOS:Keil RTX
 #include "encoder.h"
+#include "trace.h"
 
 /** Thread to send signals from encoder */
 static  	osThreadId  	destination_thread_id;
@@ -9,31 +10,13 @@ static int16_t encoder_state = 0;
 
 void Encoder_Init(void)
 {
-	/** Enable GPIO clocks for GPIOA and GPIOF */
-	RCC->AHBENR |= RCC_AHBENR_GPIOAEN;
-	RCC->AHBENR |= RCC_AHBENR_GPIOFEN;
-
-  /* Init GPIO Pins */
-	/* Encoder Pin A */
-  ENCODER_APORT->MODER   &= ~(3ul << 2*ENCODER_APINn);
-  ENCODER_APORT->OSPEEDR &= ~(3ul << 2*ENCODER_APINn);
-  ENCODER_APORT->OSPEEDR |=  (1ul << 2*ENCODER_APINn);
-  ENCODER_APORT->PUPDR   &= ~(3ul << 2*ENCODER_APINn);
-	ENCODER_APORT->PUPDR   |=  (1ul << 2*ENCODER_APINn);
-
-	/* Encoder Pin B */
-  ENCODER_BPORT->MODER   &= ~(3ul << 2*ENCODER_BPINn);
-  ENCODER_BPORT->OSPEEDR &= ~(3ul << 2*ENCODER_BPINn);
-  ENCODER_BPORT->OSPEEDR |=  (1ul << 2*ENCODER_BPINn);
-  ENCODER_BPORT->PUPDR   &= ~(3ul << 2*ENCODER_BPINn);
-	ENCODER_BPORT->PUPDR   |=  (1ul << 2*ENCODER_BPINn);
-	
-	/* Encoder Key pin */
-  ENCODER_KPORT->MODER   &= ~(3ul << 2*ENCODER_KPINn);
-  ENCODER_KPORT->OSPEEDR &= ~(3ul << 2*ENCODER_KPINn);
-  ENCODER_KPORT->OSPEEDR |=  (1ul << 2*ENCODER_KPINn);
-  ENCODER_KPORT->PUPDR   &= ~(3ul << 2*ENCODER_KPINn);
-	ENCODER_KPORT->PUPDR   |=  (1ul << 2*ENCODER_KPINn);
+	static const gpio_cfg_t pa = GPIO_CFG(ENCODER_PINMAP, GPIO_PA);
+	static const gpio_cfg_t pf = GPIO_CFG(ENCODER_PINMAP, GPIO_PF);
+
+	/** Enable GPIO clocks, inputs with pullup */
+	RCC->AHBENR |= GPIO_CLOCKS(ENCODER_PINMAP);
+	Gpio_Config(GPIOA, &pa);
+	Gpio_Config(GPIOF, &pf);
 	
 	/* Enable SYSCFG Clock */
 	RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
@@ -82,11 +65,13 @@ void EXTI4_15_IRQHandler(void)
 		EXTI->PR |= EXTI_PR_PR10;
 		if ((ENCODER_BPORT->IDR & ENCODER_BPIN) == 0)
 		{
+			TRACE_EVT(TRC_ENC_STEP, 1);
 		  osSignalSet(destination_thread_id, ENCODER_UP);
 			encoder_state++;
 		}
 		else
 		{
+			TRACE_EVT(TRC_ENC_STEP, 0);
 		  osSignalSet(destination_thread_id, ENCODER_DN);	
       encoder_state--;			
 		}
@@ -102,6 +87,7 @@ void EXTI0_1_IRQHandler(void)
 	{
 		// Clear EXTI interrupt pending flag (EXTI->PR).
 		EXTI->PR |= EXTI_PR_PR0 ;
+		TRACE_EVT(TRC_ENC_KEY, 0);
 		osSignalSet(destination_thread_id, ENCODER_BUTTON);
 	}
 }
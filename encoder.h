@@ -41,18 +41,17 @@
 #define __ENCODER_H__
 
 
-/// Encoder pinout definitions
+#include "pinmap.h"
+
+/// Encoder pinout, pin numbers in pinmap.h
 //A - Pin for encoder "A" pin ---> triggers EXTI
-#define ENCODER_APORT      GPIOA
-#define ENCODER_APINn      10
+#define ENCODER_APORT      GPIO_PORT(ENCODER_APORTn)
 
 //B - Pin for encoder "B" pin 
-#define ENCODER_BPORT      GPIOA
-#define ENCODER_BPINn      9
+#define ENCODER_BPORT      GPIO_PORT(ENCODER_BPORTn)
 
 //A - Pin for encoder "K" pin ---> KEy, triggers EXTI
-#define ENCODER_KPORT      GPIOF
-#define ENCODER_KPINn      0
+#define ENCODER_KPORT      GPIO_PORT(ENCODER_KPORTn)
 
 #define ENCODER_APIN		((uint16_t)(1U<<ENCODER_APINn))
 #define ENCODER_BPIN		((uint16_t)(1U<<ENCODER_BPINn))
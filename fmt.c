@@ -0,0 +1,172 @@
+/**
+  ******************************************************************************
+  * @file    fmt.c
+  * @author  e.pavlin.si
+  * @brief   Fixed-width display formatting
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * Cortex-M0 has no divide instruction, so digits are produced by
+  * subtracting powers of ten instead of calling __aeabi_uidiv per digit.
+  * Stack use is one 11 byte digit buffer.
+  *
+  */
+
+#include "fmt.h"
+
+static const uint32_t Fmt_Pow10[10] =
+{
+	1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+	10000UL, 1000UL, 100UL, 10UL, 1UL
+};
+
+
+/**
+  * Convert v to decimal digits, at least mindig digits.
+  * Returns number of digits in buf.
+  */
+static uint8_t Fmt_Digits(char *buf, uint32_t v, uint8_t mindig)
+{
+	uint8_t i, n = 0;
+	char d;
+
+	for (i = 0; i < 10; i++)
+	{
+		d = '0';
+		while (v >= Fmt_Pow10[i])
+		{
+			v -= Fmt_Pow10[i];
+			d++;
+		}
+		if ((d != '0') || (n != 0) || (i >= 10 - mindig))
+		{
+			buf[n++] = d;
+		}
+	}
+	return n;
+}
+
+
+/**
+  * Copy string, pad with spaces to width (0 = no padding)
+  */
+char *Fmt_Str(char *dst, char *end, const char *s, uint8_t width)
+{
+	while (*s)
+	{
+		if (dst < end) *dst++ = *s;
+		s++;
+		if (width) width--;
+	}
+	while (width--)
+		if (dst < end) *dst++ = ' ';
+	return dst;
+}
+
+
+char *Fmt_Char(char *dst, char *end, char c)
+{
+	if (dst < end) *dst++ = c;
+	return dst;
+}
+
+
+/**
+  * Unsigned integer, right aligned to width with pad character
+  */
+char *Fmt_Uint(char *dst, char *end, uint32_t v, uint8_t width, char pad)
+{
+	char buf[10];
+	uint8_t n, i;
+
+	n = Fmt_Digits(buf, v, 1);
+	while (width > n)
+	{
+		if (dst < end) *dst++ = pad;
+		width--;
+	}
+	for (i = 0; (i < n) && (dst < end); i++) *dst++ = buf[i];
+	return dst;
+}
+
+
+/**
+  * Signed integer, right aligned to width with spaces
+  */
+char *Fmt_Int(char *dst, char *end, int32_t v, uint8_t width)
+{
+	return Fmt_Fixed(dst, end, v, 0, width);
+}
+
+
+/**
+  * Fixed point decimal: v / 10^dec with dec digits after the point,
+  * e.g. Fmt_Fixed(p, e, 702, 2, 0) gives "7.02". Right aligned to width.
+  */
+char *Fmt_Fixed(char *dst, char *end, int32_t v, uint8_t dec, uint8_t width)
+{
+	char buf[11];
+	uint8_t n, i, len;
+	uint32_t u;
+
+	/* negated unsigned, defined for INT32_MIN too */
+	u = (v < 0) ? (uint32_t)0 - (uint32_t)v : (uint32_t)v;
+	n = Fmt_Digits(buf, u, (uint8_t)(dec + 1));
+	len = (uint8_t)(n + (dec ? 1 : 0) + ((v < 0) ? 1 : 0));
+	while (width > len)
+	{
+		if (dst < end) *dst++ = ' ';
+		width--;
+	}
+	if ((v < 0) && (dst < end)) *dst++ = '-';
+	for (i = 0; (i < n) && (dst < end); i++)
+	{
+		if (dec && (i == n - dec))
+		{
+			*dst++ = '.';
+			if (dst == end) break;
+		}
+		*dst++ = buf[i];
+	}
+	return dst;
+}
+
+
+/**
+  * Pad line with spaces from dst up to cols and terminate it.
+  * Returns line, ready for LCD_Puts().
+  */
+char *Fmt_Fill(char *line, char *dst, uint8_t cols)
+{
+	while (dst < line + cols) *dst++ = ' ';
+	line[cols] = 0;
+	return line;
+}
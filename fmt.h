@@ -0,0 +1,29 @@
+/**
+ * @file     fmt.h
+ * @brief    Fixed-width display formatting Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Replacement for snprintf() in LCD output. All functions write
+ *           at dst and return pointer past the last written character, so
+ *           calls can be chained. Output is not terminated until Fmt_Fill().
+ *
+ *           Nothing is written at or past end; what does not fit is cut
+ *           off, so a line never grows past the buffer, e.g. end = str + 16
+ *           for a display line in char str[17].
+ *
+ */
+
+#ifndef ___FMT_H_
+#define ___FMT_H_
+
+#include <stdint.h>
+
+char *Fmt_Str(char *dst, char *end, const char *s, uint8_t width);
+char *Fmt_Char(char *dst, char *end, char c);
+char *Fmt_Uint(char *dst, char *end, uint32_t v, uint8_t width, char pad);
+char *Fmt_Int(char *dst, char *end, int32_t v, uint8_t width);
+char *Fmt_Fixed(char *dst, char *end, int32_t v, uint8_t dec, uint8_t width);
+char *Fmt_Fill(char *line, char *dst, uint8_t cols);
+
+#endif
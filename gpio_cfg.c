@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file    gpio_cfg.c
+  * @author  e.pavlin.si
+  * @brief   Compile-time GPIO configuration
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  */
+
+#include "stm32f0xx.h"                  // Device header
+#include "pinmap.h"
+
+/* A pin used twice, by one driver or by two */
+GPIO_ASSERT(GPIO_FREE(BOARD_PINMAP, GPIO_PA), pin_conflict_on_port_a);
+GPIO_ASSERT(GPIO_FREE(BOARD_PINMAP, GPIO_PB), pin_conflict_on_port_b);
+GPIO_ASSERT(GPIO_FREE(BOARD_PINMAP, GPIO_PC), pin_conflict_on_port_c);
+GPIO_ASSERT(GPIO_FREE(BOARD_PINMAP, GPIO_PF), pin_conflict_on_port_f);
+
+/* A port without registers in GPIO_PORT() */
+GPIO_ASSERT((GPIO_CLOCKS(BOARD_PINMAP) & ~(RCC_AHBENR_GPIOAEN | RCC_AHBENR_GPIOBEN |
+	          RCC_AHBENR_GPIOCEN | RCC_AHBENR_GPIOFEN)) == 0, pin_on_unknown_port);
+
+
+/**
+  * Write the pins of cfg on one port, one access per register
+  */
+void Gpio_Config(GPIO_TypeDef *port, const gpio_cfg_t *cfg)
+{
+	port->MODER   = (port->MODER   & ~cfg->mask2) | cfg->moder;
+	port->OTYPER  =  port->OTYPER  & ~cfg->pins;
+	port->OSPEEDR = (port->OSPEEDR & ~cfg->mask2) | cfg->ospeedr;
+	port->PUPDR   = (port->PUPDR   & ~cfg->mask2) | cfg->pupdr;
+}
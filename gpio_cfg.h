@@ -0,0 +1,94 @@
+/**
+ * @file     gpio_cfg.h
+ * @brief    Compile-time GPIO configuration Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     A driver lists its pins once, as a pin map macro:
+ *
+ *             #define XY_PINMAP(X, p) \
+ *               X(p, GPIO_PA, 5, GPIO_MODE_OUT, GPIO_PULL_NONE) \
+ *               X(p, GPIO_PA, 6, GPIO_MODE_IN,  GPIO_PULL_UP)
+ *
+ *           GPIO_CFG(XY_PINMAP, GPIO_PA) expands the map into the set and
+ *           clear masks of port A, all constant expressions, and
+ *           Gpio_Config() writes each register of the port once. Pins are
+ *           push-pull, medium speed.
+ *
+ *           GPIO_FREE() is true if no pin is listed twice on a port; the
+ *           maps of the board are checked with it in gpio_cfg.c, so a pin
+ *           conflict is a compile error.
+ *
+ */
+
+#ifndef ___GPIO_CFG_H_
+#define ___GPIO_CFG_H_
+
+#include "stm32f0xx.h"                  // Device header
+
+/** \brief Port numbers, GPIOx = GPIOA + 0x400 * n, RCC_AHBENR bit 17 + n */
+#define GPIO_PA							0
+#define GPIO_PB							1
+#define GPIO_PC							2
+#define GPIO_PF							5
+
+/** \brief MODER values */
+#define GPIO_MODE_IN				0
+#define GPIO_MODE_OUT				1
+#define GPIO_MODE_AN				3			/*!< analog, for the ADC */
+
+/** \brief PUPDR values */
+#define GPIO_PULL_NONE			0
+#define GPIO_PULL_UP				1
+#define GPIO_PULL_DOWN			2
+
+/** \brief OSPEEDR value of all pins */
+#define GPIO_SPEED_MEDIUM		1
+
+/** \brief Port registers from a port number, folds to a constant */
+#define GPIO_PORT(n)				(((n) == GPIO_PA) ? GPIOA : ((n) == GPIO_PB) ? GPIOB : \
+														 ((n) == GPIO_PC) ? GPIOC : GPIOF)
+
+/** \brief Value v in the 1 or 2 bit field of a pin, 0 if the pin is not on port p */
+#define GPIO_F1(p, port, pin, v)	(((port) == (p)) ? ((uint32_t)(v) << (pin)) : 0UL)
+#define GPIO_F2(p, port, pin, v)	(((port) == (p)) ? ((uint32_t)(v) << (2 * (pin))) : 0UL)
+
+/** \brief Pin map visitors, each adds one pin to an expression */
+#define GPIO_X_USED(p, port, pin, mode, pull)		| GPIO_F1(p, port, pin, 1)
+#define GPIO_X_SUM(p, port, pin, mode, pull)		+ GPIO_F1(p, port, pin, 1)
+#define GPIO_X_MASK2(p, port, pin, mode, pull)	| GPIO_F2(p, port, pin, 3)
+#define GPIO_X_MODE(p, port, pin, mode, pull)		| GPIO_F2(p, port, pin, mode)
+#define GPIO_X_SPEED(p, port, pin, mode, pull)	| GPIO_F2(p, port, pin, GPIO_SPEED_MEDIUM)
+#define GPIO_X_PULL(p, port, pin, mode, pull)		| GPIO_F2(p, port, pin, pull)
+#define GPIO_X_CLOCK(p, port, pin, mode, pull)	| (1UL << (17 + (port)))
+
+/** \brief Pins of a map on port p, as a mask */
+#define GPIO_USED(map, p)		(0UL map(GPIO_X_USED, p))
+
+/** \brief No pin of a map is listed twice on port p */
+#define GPIO_FREE(map, p)		((0UL map(GPIO_X_SUM, p)) == GPIO_USED(map, p))
+
+/** \brief RCC_AHBENR clock enables of all ports in a map */
+#define GPIO_CLOCKS(map)		(0UL map(GPIO_X_CLOCK, 0))
+
+/** \brief Initializer of the gpio_cfg_t for port p */
+#define GPIO_CFG(map, p)		{ 0UL map(GPIO_X_MASK2, p), 0UL map(GPIO_X_MODE, p), \
+														  0UL map(GPIO_X_SPEED, p), 0UL map(GPIO_X_PULL, p), \
+														  (uint16_t)GPIO_USED(map, p) }
+
+/** \brief Compile error if c is false */
+#define GPIO_ASSERT(c, name)	typedef char gpio_assert_##name[(c) ? 1 : -1]
+
+/** \brief Configuration of the pins of one port */
+typedef struct
+{
+	uint32_t mask2;					/*!< 2-bit fields of the pins */
+	uint32_t moder;
+	uint32_t ospeedr;
+	uint32_t pupdr;
+	uint16_t pins;					/*!< 1-bit fields, OTYPER cleared */
+} gpio_cfg_t;
+
+void Gpio_Config(GPIO_TypeDef *port, const gpio_cfg_t *cfg);
+
+#endif
@@ -0,0 +1,200 @@
+/**
+ * @file     cmsis_os.h
+ * @brief    Host implementation of the CMSIS-RTOS v1 API subset used by the
+ *           firmware
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Types, status codes and object definition macros follow the
+ *           Keil RTX cmsis_os.h. The kernel is host/sim/os_sim.cpp, running
+ *           on the simulator's virtual clock (host/sim/sim.h). Thread
+ *           definitions also carry the thread name for reports.
+ *
+ */
+
+#ifndef _CMSIS_OS_H
+#define _CMSIS_OS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define osCMSIS           0x10002
+#define osCMSIS_RTX       ((4<<16)|80)
+#define osKernelSystemId  "RTX V4.80 (host)"
+
+#define osFeature_MainThread   1
+#define osFeature_Pool         0
+#define osFeature_MailQ        0
+#define osFeature_MessageQ     0
+#define osFeature_Signals      16
+#define osFeature_Semaphore    65535
+#define osFeature_Wait         0
+#define osFeature_SysTick      1
+
+typedef enum
+{
+	osPriorityIdle          = -3,
+	osPriorityLow           = -2,
+	osPriorityBelowNormal   = -1,
+	osPriorityNormal        =  0,
+	osPriorityAboveNormal   = +1,
+	osPriorityHigh          = +2,
+	osPriorityRealtime      = +3,
+	osPriorityError         =  0x84
+} osPriority;
+
+#define osWaitForever     0xFFFFFFFF
+
+typedef enum
+{
+	osOK                    =     0,
+	osEventSignal           =  0x08,
+	osEventMessage          =  0x10,
+	osEventMail             =  0x20,
+	osEventTimeout          =  0x40,
+	osErrorParameter        =  0x80,
+	osErrorResource         =  0x81,
+	osErrorTimeoutResource  =  0xC1,
+	osErrorISR              =  0x82,
+	osErrorISRRecursive     =  0x83,
+	osErrorPriority         =  0x84,
+	osErrorNoMemory         =  0x85,
+	osErrorValue            =  0x86,
+	osErrorOS               =  0xFF,
+	os_status_reserved      =  0x7FFFFFFF
+} osStatus;
+
+typedef enum
+{
+	osTimerOnce             =     0,
+	osTimerPeriodic         =     1
+} os_timer_type;
+
+typedef void (*os_pthread) (void const *argument);
+typedef void (*os_ptimer) (void const *argument);
+
+typedef struct os_thread_cb *osThreadId;
+typedef struct os_timer_cb *osTimerId;
+typedef struct os_mutex_cb *osMutexId;
+typedef struct os_semaphore_cb *osSemaphoreId;
+
+typedef struct os_thread_def
+{
+	os_pthread               pthread;
+	osPriority             tpriority;
+	uint32_t               instances;
+	uint32_t               stacksize;
+	const char                 *name;
+} osThreadDef_t;
+
+typedef struct os_timer_def
+{
+	os_ptimer                 ptimer;
+	void                      *timer;
+} osTimerDef_t;
+
+typedef struct os_mutex_def
+{
+	void                      *mutex;
+} osMutexDef_t;
+
+typedef struct os_semaphore_def
+{
+	void                  *semaphore;
+} osSemaphoreDef_t;
+
+typedef struct
+{
+	osStatus                 status;
+	union
+	{
+		uint32_t                    v;
+		void                       *p;
+		int32_t               signals;
+	} value;
+	union
+	{
+		void                   *mail_id;
+		void                *message_id;
+	} def;
+} osEvent;
+
+
+/*----------------------------------------------------------------------------
+ *      Kernel
+ *---------------------------------------------------------------------------*/
+osStatus osKernelInitialize (void);
+osStatus osKernelStart (void);
+int32_t osKernelRunning (void);
+uint32_t osKernelSysTick (void);
+
+extern const uint32_t os_tickfreq;
+#define osKernelSysTickFrequency os_tickfreq
+#define osKernelSysTickMicroSec(microsec) (((uint64_t)(microsec) * (osKernelSysTickFrequency)) / 1000000)
+
+
+/*----------------------------------------------------------------------------
+ *      Threads
+ *---------------------------------------------------------------------------*/
+#define osThreadDef(name, priority, instances, stacksz)  \
+const osThreadDef_t os_thread_def_##name = \
+{ (name), (priority), (instances), (stacksz), #name }
+
+#define osThread(name)  \
+&os_thread_def_##name
+
+osThreadId osThreadCreate (const osThreadDef_t *thread_def, void *argument);
+osThreadId osThreadGetId (void);
+osStatus osThreadTerminate (osThreadId thread_id);
+osStatus osThreadYield (void);
+osStatus osThreadSetPriority (osThreadId thread_id, osPriority priority);
+osPriority osThreadGetPriority (osThreadId thread_id);
+
+
+/*----------------------------------------------------------------------------
+ *      Generic wait
+ *---------------------------------------------------------------------------*/
+osStatus osDelay (uint32_t millisec);
+
+
+/*----------------------------------------------------------------------------
+ *      Timers
+ *---------------------------------------------------------------------------*/
+#define osTimerDef(name, function)  \
+uint32_t os_timer_cb_##name[6]; \
+const osTimerDef_t os_timer_def_##name = \
+{ (function), (os_timer_cb_##name) }
+
+#define osTimer(name) \
+&os_timer_def_##name
+
+osTimerId osTimerCreate (const osTimerDef_t *timer_def, os_timer_type type, void *argument);
+osStatus osTimerStart (osTimerId timer_id, uint32_t millisec);
+osStatus osTimerStop (osTimerId timer_id);
+osStatus osTimerDelete (osTimerId timer_id);
+
+
+/*----------------------------------------------------------------------------
+ *      Signals
+ *---------------------------------------------------------------------------*/
+int32_t osSignalSet (osThreadId thread_id, int32_t signals);
+int32_t osSignalClear (osThreadId thread_id, int32_t signals);
+osEvent osSignalWait (int32_t signals, uint32_t millisec);
+
+
+/*----------------------------------------------------------------------------
+ *      Mutexes
+ *---------------------------------------------------------------------------*/
+#define osMutexDef(name)  \
+uint32_t os_mutex_cb_##name[4] = { 0 }; \
+const osMutexDef_t os_mutex_def_##name = { (os_mutex_cb_##name) }
+
+#define osMutex(name)  \
+&os_mutex_def_##name
+
+osMutexId osMutexCreate (const osMutexDef_t *mutex_def);
+osStatus osMutexWait (osMutexId mutex_id, uint32_t millisec);
+osStatus osMutexRelease (osMutexId mutex_id);
+osStatus osMutexDelete (osMutexId mutex_id);
+
+#endif
@@ -0,0 +1,284 @@
+/**
+ * @file     stm32f0xx.h
+ * @brief    Host replacement of the STM32F070x6 device header
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Register blocks have the CMSIS names and layout, but every
+ *           register is a SimReg object whose accesses are routed to the
+ *           simulator (host/sim). Only the peripherals and bit definitions
+ *           used by the firmware are provided. Must be compiled as C++.
+ *
+ */
+
+#ifndef __STM32F0XX_H
+#define __STM32F0XX_H
+
+#include <stdint.h>
+
+#define STM32F070x6
+
+uint32_t Sim_RegRead(const struct SimReg *r);
+void Sim_RegWrite(struct SimReg *r, uint32_t v);
+
+/** \brief One memory mapped peripheral register */
+struct SimReg
+{
+	uint32_t v;
+
+	SimReg() : v(0) {}
+	operator uint32_t() const { return Sim_RegRead(this); }
+	SimReg &operator=(const SimReg &r) { Sim_RegWrite(this, (uint32_t)r); return *this; }
+	/* Operands are truncated to 32 bits as on the target, where ~(3ul << n)
+	 * is a 32 bit value; on a 64 bit host it is not. */
+	template <class T> SimReg &operator=(T x) { Sim_RegWrite(this, (uint32_t)x); return *this; }
+	template <class T> SimReg &operator|=(T x) { Sim_RegWrite(this, Sim_RegRead(this) | (uint32_t)x); return *this; }
+	template <class T> SimReg &operator&=(T x) { Sim_RegWrite(this, Sim_RegRead(this) & (uint32_t)x); return *this; }
+	template <class T> SimReg &operator^=(T x) { Sim_RegWrite(this, Sim_RegRead(this) ^ (uint32_t)x); return *this; }
+};
+
+#define __IO
+
+/*----------------------------------------------------------------------------
+ *  Peripheral register blocks
+ *---------------------------------------------------------------------------*/
+typedef struct { SimReg MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2], BRR; } GPIO_TypeDef;
+typedef struct { SimReg CR, CFGR, CIR, APB2RSTR, APB1RSTR, AHBENR, APB2ENR, APB1ENR, BDCR, CSR, AHBRSTR, CFGR2, CFGR3, CR2; } RCC_TypeDef;
+typedef struct { SimReg IMR, EMR, RTSR, FTSR, SWIER, PR; } EXTI_TypeDef;
+typedef struct { SimReg CFGR1, RESERVED, EXTICR[4], CFGR2; } SYSCFG_TypeDef;
+typedef struct { SimReg ISR, IER, CR, CFGR1, CFGR2, SMPR, RESERVED1, RESERVED2, TR, RESERVED3, CHSELR, RESERVED4[5], DR; } ADC_TypeDef;
+typedef struct { SimReg CCR; } ADC_Common_TypeDef;
+typedef struct { SimReg CCR, CNDTR, CPAR, CMAR, RESERVED; } DMA_Channel_TypeDef;
+typedef struct { SimReg ISR, IFCR; } DMA_TypeDef;
+typedef struct { SimReg CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR, CCR1, CCR2, CCR3, CCR4, BDTR, DCR, DMAR, OR; } TIM_TypeDef;
+typedef struct { SimReg CTRL, LOAD, VAL, CALIB; } SysTick_Type;
+typedef struct { SimReg CPUID, ICSR, RESERVED0, AIRCR, SCR, CCR, RESERVED1, SHP[2], SHCSR; } SCB_Type;
+typedef struct { SimReg CR, CSR; } PWR_TypeDef;
+typedef struct { SimReg ACR, KEYR, OPTKEYR, SR, CR, AR, RESERVED, OBR, WRPR; } FLASH_TypeDef;
+
+extern GPIO_TypeDef Sim_GPIO[6];
+extern RCC_TypeDef Sim_RCC;
+extern EXTI_TypeDef Sim_EXTI;
+extern SYSCFG_TypeDef Sim_SYSCFG;
+extern ADC_TypeDef Sim_ADC1;
+extern ADC_Common_TypeDef Sim_ADC;
+extern DMA_TypeDef Sim_DMA1;
+extern DMA_Channel_TypeDef Sim_DMA1_Channel[5];
+extern TIM_TypeDef Sim_TIM3, Sim_TIM14, Sim_TIM16, Sim_TIM17;
+extern SysTick_Type Sim_SysTick;
+extern SCB_Type Sim_SCB;
+extern PWR_TypeDef Sim_PWR;
+extern FLASH_TypeDef Sim_FLASH;
+
+#define GPIOA             (&Sim_GPIO[0])
+#define GPIOB             (&Sim_GPIO[1])
+#define GPIOC             (&Sim_GPIO[2])
+#define GPIOD             (&Sim_GPIO[3])
+#define GPIOF             (&Sim_GPIO[5])
+#define RCC               (&Sim_RCC)
+#define EXTI              (&Sim_EXTI)
+#define SYSCFG            (&Sim_SYSCFG)
+#define ADC1              (&Sim_ADC1)
+#define ADC               (&Sim_ADC)
+#define DMA1              (&Sim_DMA1)
+#define DMA1_Channel1     (&Sim_DMA1_Channel[0])
+#define DMA1_Channel2     (&Sim_DMA1_Channel[1])
+#define DMA1_Channel3     (&Sim_DMA1_Channel[2])
+#define DMA1_Channel4     (&Sim_DMA1_Channel[3])
+#define DMA1_Channel5     (&Sim_DMA1_Channel[4])
+#define TIM3              (&Sim_TIM3)
+#define TIM14             (&Sim_TIM14)
+#define TIM16             (&Sim_TIM16)
+#define TIM17             (&Sim_TIM17)
+#define SysTick           (&Sim_SysTick)
+#define SCB               (&Sim_SCB)
+#define PWR               (&Sim_PWR)
+#define FLASH             (&Sim_FLASH)
+
+/** Target memory map; host data lives elsewhere */
+#define SRAM_BASE         ((uint32_t)0x20000000)
+
+/*----------------------------------------------------------------------------
+ *  Interrupts
+ *---------------------------------------------------------------------------*/
+typedef enum
+{
+	NonMaskableInt_IRQn = -14,
+	HardFault_IRQn      = -13,
+	SVC_IRQn            = -5,
+	PendSV_IRQn         = -2,
+	SysTick_IRQn        = -1,
+	WWDG_IRQn           = 0,
+	RTC_IRQn            = 2,
+	FLASH_IRQn          = 3,
+	RCC_IRQn            = 4,
+	EXTI0_1_IRQn        = 5,
+	EXTI2_3_IRQn        = 6,
+	EXTI4_15_IRQn       = 7,
+	DMA1_Channel1_IRQn  = 9,
+	DMA1_Channel2_3_IRQn = 10,
+	DMA1_Channel4_5_IRQn = 11,
+	ADC1_IRQn           = 12,
+	TIM1_BRK_UP_TRG_COM_IRQn = 13,
+	TIM1_CC_IRQn        = 14,
+	TIM3_IRQn           = 16,
+	TIM14_IRQn          = 19,
+	TIM16_IRQn          = 21,
+	TIM17_IRQn          = 22,
+	I2C1_IRQn           = 23,
+	SPI1_IRQn           = 25,
+	USART1_IRQn         = 27,
+	USART2_IRQn         = 28
+} IRQn_Type;
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+uint32_t NVIC_GetPriority(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+uint32_t NVIC_GetPendingIRQ(IRQn_Type irq);
+
+/** Simulator: interrupt enabled in NVIC and not masked by PRIMASK */
+uint8_t Sim_IrqEnabled(IRQn_Type irq);
+
+/** Core intrinsics */
+void __nop(void);
+#define __NOP()           __nop()
+void __WFI(void);
+void __WFE(void);
+void __DMB(void);
+void __DSB(void);
+void __ISB(void);
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+uint32_t __get_PSP(void);
+uint32_t __get_MSP(void);
+#define __inline          inline
+
+extern uint32_t SystemCoreClock;
+void SystemInit(void);
+void SystemCoreClockUpdate(void);
+
+/*----------------------------------------------------------------------------
+ *  Bit definitions
+ *---------------------------------------------------------------------------*/
+
+/* RCC */
+#define RCC_CR_HSION                 ((uint32_t)0x00000001)
+#define RCC_CR_HSIRDY                ((uint32_t)0x00000002)
+#define RCC_CR_HSEON                 ((uint32_t)0x00010000)
+#define RCC_CR_HSERDY                ((uint32_t)0x00020000)
+#define RCC_CR_PLLON                 ((uint32_t)0x01000000)
+#define RCC_CR_PLLRDY                ((uint32_t)0x02000000)
+#define RCC_CFGR_SW                  ((uint32_t)0x00000003)
+#define RCC_CFGR_SW_HSI              ((uint32_t)0x00000000)
+#define RCC_CFGR_SW_HSE              ((uint32_t)0x00000001)
+#define RCC_CFGR_SW_PLL              ((uint32_t)0x00000002)
+#define RCC_CFGR_SWS                 ((uint32_t)0x0000000C)
+#define RCC_CFGR_SWS_HSI             ((uint32_t)0x00000000)
+#define RCC_CFGR_SWS_HSE             ((uint32_t)0x00000004)
+#define RCC_CFGR_SWS_PLL             ((uint32_t)0x00000008)
+#define RCC_CFGR_HPRE_DIV1           ((uint32_t)0x00000000)
+#define RCC_CFGR_PPRE_DIV1           ((uint32_t)0x00000000)
+#define RCC_CFGR_PLLSRC              ((uint32_t)0x00018000)
+#define RCC_CFGR_PLLSRC_HSI_PREDIV   ((uint32_t)0x00008000)
+#define RCC_CFGR_PLLXTPRE            ((uint32_t)0x00020000)
+#define RCC_CFGR_PLLMUL              ((uint32_t)0x003C0000)
+#define RCC_CFGR_PLLMUL12            ((uint32_t)0x00280000)
+#define RCC_CFGR2_PREDIV_DIV2        ((uint32_t)0x00000001)
+#define RCC_CR2_HSI14ON              ((uint32_t)0x00000001)
+#define RCC_CR2_HSI14RDY             ((uint32_t)0x00000002)
+#define RCC_AHBENR_DMAEN             ((uint32_t)0x00000001)
+#define RCC_AHBENR_GPIOAEN           ((uint32_t)0x00020000)
+#define RCC_AHBENR_GPIOBEN           ((uint32_t)0x00040000)
+#define RCC_AHBENR_GPIOCEN           ((uint32_t)0x00080000)
+#define RCC_AHBENR_GPIODEN           ((uint32_t)0x00100000)
+#define RCC_AHBENR_GPIOFEN           ((uint32_t)0x00400000)
+#define RCC_APB2ENR_SYSCFGEN         ((uint32_t)0x00000001)
+#define RCC_APB2ENR_ADCEN            ((uint32_t)0x00000200)
+#define RCC_APB2ENR_TIM16EN          ((uint32_t)0x00020000)
+#define RCC_APB2ENR_TIM17EN          ((uint32_t)0x00040000)
+#define RCC_APB1ENR_TIM3EN           ((uint32_t)0x00000002)
+#define RCC_APB1ENR_TIM14EN          ((uint32_t)0x00000100)
+#define RCC_APB1ENR_PWREN            ((uint32_t)0x10000000)
+
+/* FLASH */
+#define FLASH_ACR_LATENCY            ((uint32_t)0x00000001)
+#define FLASH_ACR_PRFTBE             ((uint32_t)0x00000010)
+
+/* SYSCFG */
+#define SYSCFG_EXTICR1_EXTI0_PA      ((uint16_t)0x0000)
+#define SYSCFG_EXTICR1_EXTI0_PF      ((uint16_t)0x0005)
+#define SYSCFG_EXTICR3_EXTI10_PA     ((uint16_t)0x0000)
+
+/* EXTI */
+#define EXTI_IMR_MR0                 ((uint32_t)0x00000001)
+#define EXTI_IMR_MR10                ((uint32_t)0x00000400)
+#define EXTI_RTSR_TR0                ((uint32_t)0x00000001)
+#define EXTI_RTSR_TR10               ((uint32_t)0x00000400)
+#define EXTI_FTSR_TR0                ((uint32_t)0x00000001)
+#define EXTI_FTSR_TR10               ((uint32_t)0x00000400)
+#define EXTI_PR_PR0                  ((uint32_t)0x00000001)
+#define EXTI_PR_PR10                 ((uint32_t)0x00000400)
+
+/* ADC */
+#define ADC_ISR_ADRDY                ((uint32_t)0x00000001)
+#define ADC_ISR_EOC                  ((uint32_t)0x00000004)
+#define ADC_ISR_EOSEQ                ((uint32_t)0x00000008)
+#define ADC_CR_ADEN                  ((uint32_t)0x00000001)
+#define ADC_CR_ADDIS                 ((uint32_t)0x00000002)
+#define ADC_CR_ADSTART               ((uint32_t)0x00000004)
+#define ADC_CR_ADSTP                 ((uint32_t)0x00000010)
+#define ADC_CR_ADCAL                 ((uint32_t)0x80000000)
+#define ADC_CFGR1_DMAEN              ((uint32_t)0x00000001)
+#define ADC_CFGR1_DMACFG             ((uint32_t)0x00000002)
+#define ADC_CFGR1_CONT               ((uint32_t)0x00002000)
+#define ADC_CFGR1_WAIT               ((uint32_t)0x00004000)
+#define ADC_CFGR1_AUTOFF             ((uint32_t)0x00008000)
+#define ADC_SMPR_SMP                 ((uint32_t)0x00000007)
+#define ADC_CHSELR_CHSEL8            ((uint32_t)0x00000100)
+#define ADC_CHSELR_CHSEL16           ((uint32_t)0x00010000)
+#define ADC_CHSELR_CHSEL17           ((uint32_t)0x00020000)
+#define ADC_CCR_VREFEN               ((uint32_t)0x00400000)
+#define ADC_CCR_TSEN                 ((uint32_t)0x00800000)
+
+/* DMA */
+#define DMA_CCR_EN                   ((uint32_t)0x00000001)
+#define DMA_CCR_TCIE                 ((uint32_t)0x00000002)
+#define DMA_CCR_HTIE                 ((uint32_t)0x00000004)
+#define DMA_CCR_CIRC                 ((uint32_t)0x00000020)
+#define DMA_CCR_MINC                 ((uint32_t)0x00000080)
+#define DMA_CCR_PSIZE_0              ((uint32_t)0x00000100)
+#define DMA_CCR_MSIZE_0              ((uint32_t)0x00000400)
+#define DMA_CCR_PL                   ((uint32_t)0x00003000)
+
+/* TIM */
+#define TIM_CR1_CEN                  ((uint32_t)0x00000001)
+#define TIM_CR1_URS                  ((uint32_t)0x00000004)
+#define TIM_DIER_UIE                 ((uint32_t)0x00000001)
+#define TIM_DIER_CC1IE               ((uint32_t)0x00000002)
+#define TIM_SR_UIF                   ((uint32_t)0x00000001)
+#define TIM_SR_CC1IF                 ((uint32_t)0x00000002)
+#define TIM_EGR_UG                   ((uint32_t)0x00000001)
+
+/* SysTick */
+#define SysTick_CTRL_ENABLE_Msk      ((uint32_t)0x00000001)
+#define SysTick_CTRL_TICKINT_Msk     ((uint32_t)0x00000002)
+#define SysTick_CTRL_CLKSOURCE_Msk   ((uint32_t)0x00000004)
+#define SysTick_CTRL_COUNTFLAG_Msk   ((uint32_t)0x00010000)
+#define SysTick_LOAD_RELOAD_Msk      ((uint32_t)0x00FFFFFF)
+
+/* SCB */
+#define SCB_SCR_SLEEPDEEP_Msk        ((uint32_t)0x00000004)
+#define SCB_ICSR_PENDSTSET_Msk       ((uint32_t)0x04000000)
+#define SCB_ICSR_PENDSTCLR_Msk       ((uint32_t)0x02000000)
+
+/* PWR */
+#define PWR_CR_LPDS                  ((uint32_t)0x00000001)
+#define PWR_CR_PDDS                  ((uint32_t)0x00000002)
+#define PWR_CR_CWUF                  ((uint32_t)0x00000004)
+
+#endif
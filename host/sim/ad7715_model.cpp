@@ -0,0 +1,368 @@
+/**
+  ******************************************************************************
+  * @file    ad7715_model.cpp
+  * @author  e.pavlin.si
+  * @brief   Behavioral model of the AD7715 on the simulated SPI pins
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * Serial interface as in the data sheet: DIN is latched on the rising edge
+  * of SCLK, DOUT changes on the falling edge, clocks are ignored while CS
+  * is high. While waiting for a write to the communications register, ones
+  * are ignored until a zero start (DRDY) bit arrives. 32 ones in a row
+  * reset the interface.
+  *
+  * Conversions are produced lazily: the model catches up to the current
+  * time whenever the interface is clocked, so no events are scheduled.
+  *
+  * Mains hum is added after the digital filter: a sine through the
+  * sinc^3 response of the current output rate, delayed by 1.5 periods.
+  * Its notches are at the output rate and its multiples.
+  *
+  */
+
+#include "ad7715_model.h"
+#include "stm32f0xx.h"
+#include "ad7715.h"
+#include <math.h>
+#include <string.h>
+
+/** Pins, as in ad7715.c */
+#define M_SCLK_PORT		SIM_PORTA
+#define M_SCLK_PIN		5
+#define M_DIN_PORT		SIM_PORTA
+#define M_DIN_PIN			7
+#define M_DOUT_PORT		SIM_PORTA
+#define M_DOUT_PIN		6
+#define M_CS_PORT			SIM_PORTF
+#define M_CS_PIN			1
+
+/** Periods of settling after a filter reset, and of self-calibration */
+#define M_SETTLE			3
+#define M_SELFCAL			6
+
+/** Interface state */
+#define M_WAIT_COMM		0
+#define M_WRITE				1
+#define M_READ				2
+
+
+/** Local variables */
+static ad7715_ain_t m_ain;
+static void *m_ctx;
+static double m_vref;
+static double m_hum_v, m_hum_hz;				/* mains hum at the input, V peak */
+
+static uint8_t comm;								/* last communications register write */
+static uint8_t setup;
+static uint8_t test;
+static uint16_t data;
+static uint8_t drdy;								/* 1: unread result */
+
+static sim_time_t next_conv;				/* time of next result, SIM_NEVER in standby */
+static sim_time_t cal_end;					/* end of calibration, SIM_NEVER if none */
+
+static uint8_t state;
+static uint8_t nbits, bitcnt;
+static uint16_t shift;
+static uint8_t target;							/* register being written or read */
+static uint8_t ones;
+
+static ad7715_model_stats_t stats;
+
+
+static const double m_rates[2][4] =
+{
+	{ 20.0, 25.0, 100.0, 200.0 },				/* CLK = 0, 1 MHz */
+	{ 50.0, 60.0, 250.0, 500.0 },				/* CLK = 1, 2.4576 MHz */
+};
+
+static const uint8_t m_gain[4] = { 1, 2, 32, 128 };
+
+
+double AD7715_ModelRate(void)
+{
+	return m_rates[(setup >> 5) & 1][(setup >> 3) & 3];
+}
+
+
+static sim_time_t M_Period(void)
+{
+	return (sim_time_t)((double)SIM_CORE_HZ / AD7715_ModelRate() + 0.5);
+}
+
+
+/**
+  * Code for the analog input at time t
+  */
+static uint16_t M_Convert(sim_time_t t)
+{
+	double v = m_ain ? m_ain(m_ctx, t) : 0.0;
+	double x, c, T, h;
+
+	if (m_hum_v > 0.0)
+	{
+		T = 1.0 / AD7715_ModelRate();
+		h = M_PI * m_hum_hz * T;
+		h = sin(h) / h;
+		v += m_hum_v * h * h * h * sin(2.0 * M_PI * m_hum_hz * ((double)t / SIM_CORE_HZ - 1.5 * T));
+	}
+	x = v * m_gain[comm & 3] / m_vref;
+
+	if (setup & 0x04)
+		c = x * 65536.0;									/* unipolar, straight binary */
+	else
+		c = 32768.0 + x * 32768.0;				/* bipolar, offset binary */
+	if (c < 0.0) c = 0.0;
+	if (c > 65535.0) c = 65535.0;
+	return (uint16_t)floor(c + 0.5);
+}
+
+
+/**
+  * Produce all results due up to now
+  */
+static void M_Update(void)
+{
+	sim_time_t T;
+
+	if (Sim_Cycles >= cal_end)
+	{
+		cal_end = SIM_NEVER;
+		setup &= 0x3F;										/* back to normal mode */
+		stats.cal_done++;
+	}
+	if (cal_end != SIM_NEVER) return;
+
+	T = M_Period();
+	while (next_conv <= Sim_Cycles)
+	{
+		if (drdy) stats.missed++;
+		data = M_Convert(next_conv);
+		drdy = 1;
+		stats.conversions++;
+		if (stats.first_ready == 0) stats.first_ready = next_conv;
+		next_conv += T;
+	}
+}
+
+
+/**
+  * Setup or gain changed: restart the digital filter
+  */
+static void M_FilterReset(void)
+{
+	sim_time_t T = M_Period();
+
+	stats.filter_resets++;
+	drdy = 0;
+	if (cal_end != SIM_NEVER)
+	{
+		cal_end = SIM_NEVER;
+		stats.cal_aborted++;
+	}
+	if (comm & 0x04)
+	{
+		next_conv = SIM_NEVER;						/* standby */
+		return;
+	}
+	if (((setup >> 6) & 3) == AD7715_MODE_SELFCAL)
+	{
+		cal_end = Sim_Cycles + M_SELFCAL * T;
+		next_conv = cal_end + T;
+	}
+	else
+		next_conv = Sim_Cycles + M_SETTLE * T;
+}
+
+
+static void M_Dout(uint8_t level)
+{
+	Sim_SetInput(M_DOUT_PORT, M_DOUT_PIN, level);
+}
+
+
+/**
+  * A complete byte written to the communications register
+  */
+static void M_Comm(uint8_t b)
+{
+	uint8_t old = comm;
+
+	if (b & 0x40) stats.errors++;
+	comm = b & 0x3F;
+	target = (uint8_t)((b >> 4) & 3);
+	if (((old ^ comm) & 0x07) != 0) M_FilterReset();
+
+	if (b & 0x08)
+	{
+		M_Update();
+		state = M_READ;
+		bitcnt = 0;
+		switch (target)
+		{
+			case AD7715_REG_COMM:  shift = (uint16_t)(((drdy ? 0 : 1) << 7) | comm); nbits = 8; stats.comm_reads++; break;
+			case AD7715_REG_SETUP: shift = setup; nbits = 8; break;
+			case AD7715_REG_TEST:  shift = test;  nbits = 8; break;
+			default:               shift = data;  nbits = 16; stats.data_reads++; break;
+		}
+		shift = (uint16_t)(shift << (16 - nbits));
+	}
+	else if (target != AD7715_REG_COMM)
+	{
+		state = M_WRITE;
+		bitcnt = 0;
+		nbits = (target == AD7715_REG_DATA) ? 16 : 8;
+		shift = 0;
+	}
+}
+
+
+/**
+  * A complete write to setup, test or data register
+  */
+static void M_Write(void)
+{
+	switch (target)
+	{
+		case AD7715_REG_SETUP:
+			setup = (uint8_t)shift;
+			stats.setup_writes++;
+			M_FilterReset();
+			break;
+		case AD7715_REG_TEST:
+			test = (uint8_t)shift;
+			break;
+		default:
+			stats.errors++;										/* data register is read only */
+			break;
+	}
+}
+
+
+static void M_Clock(uint8_t level)
+{
+	uint8_t din;
+
+	if (Sim_GetOutput(M_CS_PORT, M_CS_PIN)) return;
+
+	if (level == 0)
+	{
+		/* falling edge: next output bit */
+		if (state == M_READ) M_Dout((uint8_t)((shift >> 15) & 1));
+		return;
+	}
+
+	/* rising edge: latch input */
+	stats.sclk++;
+	din = Sim_GetOutput(M_DIN_PORT, M_DIN_PIN);
+	ones = din ? (uint8_t)(ones + 1) : 0;
+	if (ones >= 32)
+	{
+		ones = 0;
+		state = M_WAIT_COMM;
+		bitcnt = 0;
+		stats.resets++;
+		M_Dout(1);
+		return;
+	}
+
+	switch (state)
+	{
+		case M_WAIT_COMM:
+			if ((bitcnt == 0) && din) break;			/* wait for the zero start bit */
+			shift = (uint16_t)((shift << 1) | din);
+			if (++bitcnt == 8)
+			{
+				bitcnt = 0;
+				state = M_WAIT_COMM;
+				M_Comm((uint8_t)shift);
+			}
+			break;
+
+		case M_WRITE:
+			shift = (uint16_t)((shift << 1) | din);
+			if (++bitcnt == nbits)
+			{
+				state = M_WAIT_COMM;
+				bitcnt = 0;
+				M_Write();
+			}
+			break;
+
+		case M_READ:
+			shift = (uint16_t)(shift << 1);
+			if (++bitcnt == nbits)
+			{
+				if (target == AD7715_REG_DATA) drdy = 0;
+				state = M_WAIT_COMM;
+				bitcnt = 0;
+				M_Dout(1);
+			}
+			break;
+	}
+}
+
+
+static void M_Pin(void *ctx, uint8_t port, uint8_t pin, uint8_t level, sim_time_t t)
+{
+	if ((port == M_SCLK_PORT) && (pin == M_SCLK_PIN)) M_Clock(level);
+}
+
+
+void AD7715_ModelInit(ad7715_ain_t ain, void *ctx, double vref)
+{
+	m_ain = ain;
+	m_ctx = ctx;
+	m_vref = vref;
+
+	/* power-on state: gain 1, setup 0x28 (60 Hz at 2.4576 MHz, bipolar) */
+	comm = 0x00;
+	setup = 0x28;
+	test = 0;
+	data = 0x8000;
+	drdy = 0;
+	cal_end = SIM_NEVER;
+	next_conv = Sim_Cycles + M_SETTLE * M_Period();
+	state = M_WAIT_COMM;
+	bitcnt = 0;
+	ones = 0;
+	memset(&stats, 0, sizeof(stats));
+
+	Sim_PinListen(M_SCLK_PORT, 1u << M_SCLK_PIN, M_Pin, NULL);
+	M_Dout(1);
+}
+
+
+uint16_t AD7715_ModelCode(void)
+{
+	M_Update();
+	return data;
+}
+
+
+const ad7715_model_stats_t *AD7715_ModelStats(void)
+{
+	M_Update();
+	return &stats;
+}
+
+
+void AD7715_ModelHum(double volts, double hz)
+{
+	m_hum_v = volts;
+	m_hum_hz = hz;
+}
+
+
+void AD7715_ModelClearStats(void)
+{
+	memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,59 @@
+/**
+ * @file     ad7715_model.h
+ * @brief    Behavioral model of the AD7715 on the simulated SPI pins
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Listens to SCLK (PA5), DIN (PA7) and CS (PF1) as driven by
+ *           ad7715.c and drives DOUT (PA6). Decodes the communications,
+ *           setup, test and data registers.
+ *
+ *           Conversions follow the setup register: output rate from FS
+ *           and CLK, 3 periods of settling after a setup or gain change,
+ *           6 periods for self-calibration, none in standby. Each result
+ *           is the analog input at that instant, from a pluggable source
+ *           such as the electrode model (electrode.h).
+ *
+ */
+
+#ifndef ___AD7715_MODEL_H_
+#define ___AD7715_MODEL_H_
+
+#include "sim.h"
+
+/** \brief Analog input source: differential voltage at time t */
+typedef double (*ad7715_ain_t)(void *ctx, sim_time_t t);
+
+/** \brief Model counters */
+typedef struct
+{
+	uint32_t conversions;				/*!< results produced */
+	uint32_t missed;						/*!< results overwritten before being read */
+	uint32_t data_reads;				/*!< data register reads */
+	uint32_t comm_reads;				/*!< communications register reads (DRDY polls) */
+	uint32_t setup_writes;
+	uint32_t filter_resets;			/*!< setup or gain changes restarting the filter */
+	uint32_t cal_done;					/*!< self-calibrations completed */
+	uint32_t cal_aborted;				/*!< self-calibrations cut short by a setup write */
+	uint32_t resets;						/*!< interface resets by 32 ones */
+	uint32_t errors;						/*!< protocol errors: zero bit set, write to data */
+	uint32_t sclk;							/*!< SCLK cycles with CS low */
+	sim_time_t first_ready;			/*!< time of first result after power-up */
+} ad7715_model_stats_t;
+
+/** Attach the model to the pins; vref in volts */
+void AD7715_ModelInit(ad7715_ain_t ain, void *ctx, double vref);
+
+/** Mains hum at the input, V peak; 0 for none */
+void AD7715_ModelHum(double volts, double hz);
+
+/** Output rate of the current setup, Hz */
+double AD7715_ModelRate(void);
+
+/** Last converted code */
+uint16_t AD7715_ModelCode(void);
+
+const ad7715_model_stats_t *AD7715_ModelStats(void);
+void AD7715_ModelClearStats(void);
+
+#endif
@@ -0,0 +1,128 @@
+/**
+  ******************************************************************************
+  * @file    electrode.cpp
+  * @author  e.pavlin.si
+  * @brief   pH electrode signal model
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  */
+
+#include "electrode.h"
+#include <math.h>
+
+/** Gas constant, Faraday constant */
+#define EL_R		8.314462618
+#define EL_F		96485.33212
+
+/** Defaults, see electrode.h */
+#define EL_E7				(-0.23499)
+#define EL_SLOPE		0.8602
+#define EL_TAU			3.0
+#define EL_NOISE		20e-6
+
+
+double Electrode_Nernst(double temp_c)
+{
+	return EL_R * (temp_c + 273.15) * log(10.0) / EL_F;
+}
+
+
+void Electrode_Init(electrode_t *e, double ph)
+{
+	e->e7 = EL_E7;
+	e->slope = EL_SLOPE;
+	e->temp_c = 25.0;
+	e->tau = EL_TAU;
+	e->noise = EL_NOISE;
+	e->drift = 0.0;
+	e->seed = 1;
+
+	e->ph_glass = ph;
+	e->ph_solution = ph;
+	e->t_last = 0.0;
+	e->rng = 0;
+	e->steps.clear();
+	e->next = 0;
+}
+
+
+/**
+  * Solution pH changes to ph at time t (s); steps may be added in any order
+  */
+void Electrode_Step(electrode_t *e, double t, double ph)
+{
+	electrode_step_t s;
+	size_t i = e->next;
+
+	s.t = t;
+	s.ph = ph;
+	while ((i < e->steps.size()) && (e->steps[i].t <= t)) i++;
+	e->steps.insert(e->steps.begin() + i, s);
+}
+
+
+static void Electrode_Lag(electrode_t *e, double to)
+{
+	double dt = to - e->t_last;
+
+	if (dt <= 0.0) return;
+	if (e->tau > 0.0)
+		e->ph_glass += (e->ph_solution - e->ph_glass) * (1.0 - exp(-dt / e->tau));
+	else
+		e->ph_glass = e->ph_solution;
+	e->t_last = to;
+}
+
+
+/**
+  * pH seen by the glass at time t; time must not go backwards
+  */
+double Electrode_pH(electrode_t *e, sim_time_t t)
+{
+	double ts = (double)t / (double)SIM_CORE_HZ;
+
+	while ((e->next < e->steps.size()) && (e->steps[e->next].t <= ts))
+	{
+		Electrode_Lag(e, e->steps[e->next].t);
+		e->ph_solution = e->steps[e->next].ph;
+		e->next++;
+	}
+	Electrode_Lag(e, ts);
+	return e->ph_glass;
+}
+
+
+/**
+  * Gaussian, unit variance (xorshift64 and Box-Muller)
+  */
+static double Electrode_Gauss(electrode_t *e)
+{
+	double u1, u2;
+
+	if (e->rng == 0) e->rng = 0x9E3779B97F4A7C15ULL ^ e->seed;
+	e->rng ^= e->rng << 13; e->rng ^= e->rng >> 7; e->rng ^= e->rng << 17;
+	u1 = ((double)(e->rng >> 11) + 1.0) / 9007199254740993.0;
+	e->rng ^= e->rng << 13; e->rng ^= e->rng >> 7; e->rng ^= e->rng << 17;
+	u2 = (double)(e->rng >> 11) / 9007199254740992.0;
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+
+double Electrode_Ain(void *ctx, sim_time_t t)
+{
+	electrode_t *e = (electrode_t *)ctx;
+	double ph = Electrode_pH(e, t);
+	double v;
+
+	v = e->e7 - e->slope * Electrode_Nernst(e->temp_c) * (ph - 7.0);
+	v += e->drift * e->t_last / 3600.0;
+	if (e->noise > 0.0) v += e->noise * Electrode_Gauss(e);
+	return v;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file     electrode.h
+ * @brief    pH electrode signal model for the AD7715 model
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Output voltage at the ADC input:
+ *
+ *             V = e7 - slope * k(T) * (pH - 7) + drift * t + noise
+ *
+ *           k(T) = R T ln10 / F (59.16 mV/pH at 25 C) and slope is the
+ *           electrode efficiency. The pH seen by the glass follows the
+ *           solution pH with a first order lag tau. Solution pH changes
+ *           in steps at given times. Noise is gaussian from a seeded
+ *           generator, so runs are repeatable.
+ *
+ *           The defaults put pH 4 and pH 9 on the codes of the firmware's
+ *           default calibration (30610, 23940) with Vref 2.5 V and PGA
+ *           gain 2.
+ *
+ */
+
+#ifndef ___ELECTRODE_H_
+#define ___ELECTRODE_H_
+
+#include "sim.h"
+#include <vector>
+
+typedef struct
+{
+	double t;										/*!< seconds */
+	double ph;
+} electrode_step_t;
+
+typedef struct
+{
+	/* parameters */
+	double e7;									/*!< V at pH 7 */
+	double slope;								/*!< efficiency, 1.0 = Nernst */
+	double temp_c;
+	double tau;									/*!< response time constant, s */
+	double noise;								/*!< rms, V */
+	double drift;								/*!< V per hour */
+	uint32_t seed;
+
+	/* state */
+	double ph_glass;						/*!< pH seen by the electrode */
+	double ph_solution;
+	double t_last;
+	uint64_t rng;
+	std::vector<electrode_step_t> steps;
+	size_t next;								/*!< first step not applied yet */
+} electrode_t;
+
+void Electrode_Init(electrode_t *e, double ph);
+void Electrode_Step(electrode_t *e, double t, double ph);
+double Electrode_pH(electrode_t *e, sim_time_t t);
+double Electrode_Ain(void *ctx, sim_time_t t);
+
+/** Volts per pH at a temperature, ideal electrode */
+double Electrode_Nernst(double temp_c);
+
+#endif
@@ -0,0 +1,354 @@
+/**
+  ******************************************************************************
+  * @file    hd44780_model.cpp
+  * @author  e.pavlin.si
+  * @brief   HD44780 LCD controller model with timing checks
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * Timing limits are the HD44780U data sheet values at 5 V, fosc 270 kHz.
+  * D0..D3 are not connected, so 8-bit writes during the init sequence
+  * carry zero in the low nibble.
+  *
+  */
+
+#include "hd44780_model.h"
+#include <string.h>
+
+/** Pins, as in LCD.c */
+#define HD_RS_PORT		SIM_PORTB
+#define HD_RS_PIN			1
+#define HD_BUS_PORT		SIM_PORTA
+#define HD_E_PIN			4
+#define HD_D4_PIN			3
+#define HD_D5_PIN			2
+#define HD_D6_PIN			1
+#define HD_D7_PIN			0
+#define HD_D_MASK			((1u << HD_D4_PIN) | (1u << HD_D5_PIN) | (1u << HD_D6_PIN) | (1u << HD_D7_PIN))
+
+/** Bus timing, ns */
+#define HD_PWEH_NS		230
+#define HD_CYCE_NS		500
+#define HD_AS_NS			40
+#define HD_DSW_NS			80
+
+/** Controller timing, us */
+#define HD_POWERON_US	15000
+#define HD_INIT1_US		4100
+#define HD_INIT2_US		100
+#define HD_CLEAR_US		1520
+#define HD_CMD_US			37
+#define HD_DATA_US		41
+
+#define HD_NS(ns)			((sim_time_t)(ns) * SIM_CORE_HZ / 1000000000UL)
+
+
+/** Local variables */
+static uint8_t ddram[128];
+static uint8_t cgram[64];
+static uint8_t ac;										/* address counter */
+static uint8_t ac_cg;									/* 1: AC points to CGRAM */
+static uint8_t entry = 0x02;					/* I/D and S bits */
+static uint8_t control;								/* D, C, B bits */
+static uint8_t function = 0x10;				/* DL, N, F bits; 8-bit after power-on */
+static int8_t shift;									/* display shift */
+
+static uint8_t nibble_hi, have_hi;
+static uint8_t init_sets;							/* 8-bit function sets seen */
+static uint8_t strict_mode;
+
+static sim_time_t t_power, busy_until;
+static sim_time_t t_rise, t_rise_prev, t_rs, t_data, t_first;
+
+static hd44780_stats_t stats, frame_mark;
+
+static const char *v_names[HD_V_COUNT] =
+{
+	"E pulse < 230 ns", "E cycle < 500 ns", "RS setup < 40 ns",
+	"data setup < 80 ns", "write while busy", "write before power-on delay"
+};
+
+
+static void HD_Violation(uint8_t kind)
+{
+	if (stats.v[kind]++ == 0) stats.v_first[kind] = Sim_Cycles;
+}
+
+
+/**
+  * Address counter step in DDRAM, 1 or 2 lines
+  */
+static uint8_t HD_Step(uint8_t a, int8_t d)
+{
+	if (function & 0x08)
+	{
+		if (d > 0) return (a == 0x27) ? 0x40 : (a == 0x67) ? 0x00 : (uint8_t)(a + 1);
+		return (a == 0x40) ? 0x27 : (a == 0x00) ? 0x67 : (uint8_t)(a - 1);
+	}
+	if (d > 0) return (a >= 0x4F) ? 0x00 : (uint8_t)(a + 1);
+	return (a == 0x00) ? 0x4F : (uint8_t)(a - 1);
+}
+
+
+/**
+  * Execute an instruction, return execution time in us
+  */
+static uint32_t HD_Instruction(uint8_t cmd)
+{
+	if (cmd & 0x80)
+	{
+		ac = cmd & 0x7F;
+		ac_cg = 0;
+	}
+	else if (cmd & 0x40)
+	{
+		ac = cmd & 0x3F;
+		ac_cg = 1;
+	}
+	else if (cmd & 0x20)
+	{
+		function = cmd & 0x1C;
+		if (function & 0x10)
+		{
+			init_sets++;
+			if (init_sets == 1) return HD_INIT1_US;
+			if (init_sets == 2) return HD_INIT2_US;
+		}
+	}
+	else if (cmd & 0x10)
+	{
+		if (cmd & 0x08)
+			shift = (int8_t)(shift + ((cmd & 0x04) ? 1 : -1));
+		else if (!ac_cg)
+			ac = HD_Step(ac, (cmd & 0x04) ? 1 : -1);
+	}
+	else if (cmd & 0x08)
+		control = cmd & 0x07;
+	else if (cmd & 0x04)
+		entry = cmd & 0x03;
+	else if (cmd & 0x02)
+	{
+		ac = 0;
+		ac_cg = 0;
+		shift = 0;
+		return HD_CLEAR_US;
+	}
+	else if (cmd & 0x01)
+	{
+		memset(ddram, ' ', sizeof(ddram));
+		ac = 0;
+		ac_cg = 0;
+		shift = 0;
+		entry |= 0x02;
+		return HD_CLEAR_US;
+	}
+	return HD_CMD_US;
+}
+
+
+static void HD_Data(uint8_t d)
+{
+	int8_t dir = (entry & 0x02) ? 1 : -1;
+
+	if (ac_cg)
+	{
+		cgram[ac & 0x3F] = d & 0x1F;
+		ac = (uint8_t)((ac + dir) & 0x3F);
+		return;
+	}
+	if (ddram[ac] == d) stats.redundant++;
+	ddram[ac] = d;
+	ac = HD_Step(ac, dir);
+	if (entry & 0x01) shift = (int8_t)(shift - dir);
+}
+
+
+/**
+  * Complete write of a byte (or an 8-bit mode nibble)
+  */
+static void HD_Write(uint8_t rs, uint8_t b)
+{
+	uint32_t us;
+
+	if (Sim_Cycles < t_power + SIM_US(HD_POWERON_US)) HD_Violation(HD_V_POWERON);
+	if (Sim_Cycles < busy_until)
+	{
+		HD_Violation(HD_V_BUSY);
+		if (strict_mode)
+		{
+			stats.dropped++;
+			return;
+		}
+	}
+
+	if (rs)
+	{
+		HD_Data(b);
+		stats.data++;
+		us = HD_DATA_US;
+	}
+	else
+	{
+		us = HD_Instruction(b);
+		stats.cmds++;
+	}
+	busy_until = Sim_Cycles + SIM_US(us);
+	stats.exec += SIM_US(us);
+	stats.bus += Sim_Cycles - t_first;
+}
+
+
+static uint8_t HD_Nibble(void)
+{
+	return (uint8_t)((Sim_GetOutput(HD_BUS_PORT, HD_D7_PIN) << 3) | (Sim_GetOutput(HD_BUS_PORT, HD_D6_PIN) << 2) |
+	                 (Sim_GetOutput(HD_BUS_PORT, HD_D5_PIN) << 1) |  Sim_GetOutput(HD_BUS_PORT, HD_D4_PIN));
+}
+
+
+static void HD_Pin(void *ctx, uint8_t port, uint8_t pin, uint8_t level, sim_time_t t)
+{
+	uint8_t n, rs;
+
+	if (port == HD_RS_PORT)
+	{
+		t_rs = t;
+		return;
+	}
+	if (pin != HD_E_PIN)
+	{
+		t_data = t;
+		return;
+	}
+
+	if (level)
+	{
+		t_rise_prev = t_rise;
+		t_rise = t;
+		if (t_rise_prev && (t - t_rise_prev < HD_NS(HD_CYCE_NS))) HD_Violation(HD_V_CYCE);
+		if (t - t_rs < HD_NS(HD_AS_NS)) HD_Violation(HD_V_AS);
+		if (!have_hi) t_first = t;
+		return;
+	}
+
+	/* falling edge latches the bus */
+	if (t - t_rise < HD_NS(HD_PWEH_NS)) HD_Violation(HD_V_PWEH);
+	if (t - t_data < HD_NS(HD_DSW_NS)) HD_Violation(HD_V_DSW);
+	stats.nibbles++;
+	n = HD_Nibble();
+	rs = Sim_GetOutput(HD_RS_PORT, HD_RS_PIN);
+
+	if (function & 0x10)
+	{
+		HD_Write(rs, (uint8_t)(n << 4));			/* 8-bit mode, D0..D3 low */
+		return;
+	}
+	if (!have_hi)
+	{
+		nibble_hi = n;
+		have_hi = 1;
+		return;
+	}
+	have_hi = 0;
+	HD_Write(rs, (uint8_t)((nibble_hi << 4) | n));
+}
+
+
+void HD44780_ModelInit(uint8_t strict)
+{
+	memset(ddram, ' ', sizeof(ddram));
+	memset(cgram, 0, sizeof(cgram));
+	ac = 0;
+	ac_cg = 0;
+	entry = 0x02;
+	control = 0;
+	function = 0x10;
+	shift = 0;
+	have_hi = 0;
+	init_sets = 0;
+	strict_mode = strict;
+	t_power = Sim_Cycles;
+	busy_until = Sim_Cycles + SIM_US(HD_POWERON_US);
+	t_rise = 0;
+	t_rs = 0;
+	t_data = 0;
+	memset(&stats, 0, sizeof(stats));
+	memset(&frame_mark, 0, sizeof(frame_mark));
+
+	Sim_PinListen(HD_BUS_PORT, (1u << HD_E_PIN) | HD_D_MASK, HD_Pin, NULL);
+	Sim_PinListen(HD_RS_PORT, 1u << HD_RS_PIN, HD_Pin, NULL);
+}
+
+
+void HD44780_ModelText(uint8_t row, char *buf, uint8_t cols)
+{
+	uint8_t base = (row & 1) ? 0x40 : 0x00;
+	uint8_t len = (function & 0x08) ? 40 : 80;
+	int16_t pos;
+	uint8_t i;
+
+	if (row & 2) base = (uint8_t)(base + 20);		/* 4-line modules */
+	for (i = 0; i < cols; i++)
+	{
+		pos = (int16_t)((i - shift) % len);
+		if (pos < 0) pos = (int16_t)(pos + len);
+		buf[i] = (char)ddram[base + pos];
+	}
+	buf[cols] = 0;
+}
+
+
+const uint8_t *HD44780_ModelDDRAM(void)
+{
+	return ddram;
+}
+
+
+const uint8_t *HD44780_ModelCGRAM(void)
+{
+	return cgram;
+}
+
+
+uint8_t HD44780_ModelDisplayOn(void)
+{
+	return (uint8_t)((control >> 2) & 1);
+}
+
+
+const hd44780_stats_t *HD44780_ModelStats(void)
+{
+	return &stats;
+}
+
+
+void HD44780_ModelFrame(hd44780_stats_t *frame)
+{
+	uint8_t i;
+
+	frame->nibbles = stats.nibbles - frame_mark.nibbles;
+	frame->cmds = stats.cmds - frame_mark.cmds;
+	frame->data = stats.data - frame_mark.data;
+	frame->redundant = stats.redundant - frame_mark.redundant;
+	frame->dropped = stats.dropped - frame_mark.dropped;
+	frame->bus = stats.bus - frame_mark.bus;
+	frame->exec = stats.exec - frame_mark.exec;
+	for (i = 0; i < HD_V_COUNT; i++)
+	{
+		frame->v[i] = stats.v[i] - frame_mark.v[i];
+		frame->v_first[i] = stats.v_first[i];
+	}
+	frame_mark = stats;
+}
+
+
+const char *HD44780_ModelViolation(uint8_t kind)
+{
+	return (kind < HD_V_COUNT) ? v_names[kind] : "";
+}
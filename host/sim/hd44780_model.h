@@ -0,0 +1,68 @@
+/**
+ * @file     hd44780_model.h
+ * @brief    HD44780 LCD controller model with timing checks
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Fed by the 4-bit bus of LCD.c: RS (PB1), E (PA4), D4..D7
+ *           (PA3..PA0). Latches nibbles on the falling edge of E, starting
+ *           in 8-bit mode as after power-on. Keeps DDRAM, CGRAM, address
+ *           counter, entry mode, display control and shift.
+ *
+ *           Checks bus timing (E pulse width, E cycle, RS and data setup)
+ *           and controller timing: power-on delay, the 4.1 ms and 100 us
+ *           waits of the init sequence, 1.52 ms for clear and home, 37 us
+ *           for other instructions and 41 us for data. A write that arrives
+ *           while the controller is busy is counted as a violation. It is
+ *           executed, or dropped as on a real part in strict mode.
+ *
+ */
+
+#ifndef ___HD44780_MODEL_H_
+#define ___HD44780_MODEL_H_
+
+#include "sim.h"
+
+/** \brief Violation kinds */
+#define HD_V_PWEH			0			/*!< E high shorter than 230 ns */
+#define HD_V_CYCE			1			/*!< E cycle shorter than 500 ns */
+#define HD_V_AS				2			/*!< RS changed less than 40 ns before E rise */
+#define HD_V_DSW			3			/*!< data changed less than 80 ns before E fall */
+#define HD_V_BUSY			4			/*!< write while busy */
+#define HD_V_POWERON	5			/*!< write earlier than 15 ms after power-on */
+#define HD_V_COUNT		6
+
+/** \brief Bus and controller counters */
+typedef struct
+{
+	uint32_t nibbles;
+	uint32_t cmds;
+	uint32_t data;
+	uint32_t redundant;					/*!< data writes that did not change DDRAM */
+	uint32_t dropped;						/*!< writes ignored in strict mode */
+	sim_time_t bus;							/*!< E activity, first rise to last fall of each write */
+	sim_time_t exec;						/*!< controller execution time */
+	uint32_t v[HD_V_COUNT];			/*!< violations by kind */
+	sim_time_t v_first[HD_V_COUNT];	/*!< time of first violation of a kind */
+} hd44780_stats_t;
+
+/** Attach to the pins. Power-on is now. */
+void HD44780_ModelInit(uint8_t strict);
+
+/** Visible text of a row, cols characters and a terminating zero.
+ *  CGRAM characters 0..7 are returned as codes 0..7. */
+void HD44780_ModelText(uint8_t row, char *buf, uint8_t cols);
+
+/** Raw memories */
+const uint8_t *HD44780_ModelDDRAM(void);		/*!< 128 bytes, by DDRAM address */
+const uint8_t *HD44780_ModelCGRAM(void);		/*!< 64 bytes */
+uint8_t HD44780_ModelDisplayOn(void);
+
+/** Cumulative counters, and counters since the previous frame call */
+const hd44780_stats_t *HD44780_ModelStats(void);
+void HD44780_ModelFrame(hd44780_stats_t *frame);
+
+/** Name of a violation kind */
+const char *HD44780_ModelViolation(uint8_t kind);
+
+#endif
@@ -0,0 +1,874 @@
+/**
+  ******************************************************************************
+  * @file    os_sim.cpp
+  * @author  e.pavlin.si
+  * @brief   CMSIS-RTOS v1 kernel on virtual time, for the host simulation
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * All threads run in the one host thread as ucontext coroutines, so the
+  * firmware sees exactly one thread running at a time, as on the M0.
+  *
+  * The kernel gets control through Sim_CpuHook() after every register
+  * access and __nop(). There it runs the tick when a tick period has passed
+  * and switches threads when a higher priority one became ready or the
+  * round robin slice ran out. A thread can therefore be preempted in the
+  * middle of a bit-banged transfer, as with the real SysTick.
+  *
+  * When no thread is ready, time jumps to the next wakeup, timer expiry or
+  * simulator event; that time is counted as idle. CPU time of each thread
+  * excludes interrupt handlers and kernel switches, which are counted
+  * separately.
+  *
+  */
+
+#include "os_sim.h"
+#include "stm32f0xx.h"
+#include "cpuload.h"
+#include <ucontext.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/** RTX configuration, as in rte/CMSIS/RTX_Conf_CM.c */
+#define OS_SIM_CLOCK				48000000		/* OS_CLOCK */
+#define OS_SIM_TICK					1000				/* OS_TICK, us */
+#define OS_SIM_ROBIN				0						/* OS_ROBIN */
+#define OS_SIM_ROBINTOUT		5						/* OS_ROBINTOUT, ticks */
+#define OS_SIM_STKSIZE			50					/* OS_STKSIZE, words */
+#define OS_SIM_TIMERCBQS		4						/* OS_TIMERCBQS */
+#define OS_SIM_MUTEXES			8						/* OS_MUTEXCNT */
+#define OS_SIM_TIMERPRIO		osPriorityHigh	/* OS_TIMERPRIO 5 */
+
+/** SysTick reload is OS_CLOCK * OS_TICK / 1e6 - 1, counted in core clocks */
+#define OS_SIM_TICK_CYCLES	((sim_time_t)OS_SIM_CLOCK / 1000000 * OS_SIM_TICK)
+
+/** Rough costs of RTX on a Cortex-M0, in core clocks */
+#define OS_SIM_SVC_CYCLES			40		/* any kernel call */
+#define OS_SIM_SWITCH_CYCLES	120		/* context switch */
+#define OS_SIM_TICKISR_CYCLES	150		/* SysTick handler */
+
+#define OS_SIM_THREADS			12
+#define OS_SIM_TIMERS				8
+#define OS_SIM_HOSTSTACK		(256 * 1024)
+#define OS_SIM_FOREVER			0xFFFFFFFFu
+
+/** Signal used to wake the timer thread */
+#define OS_SIM_TIMERSIG			0x8000
+
+const uint32_t os_tickfreq = OS_SIM_CLOCK;
+
+/** OS_STKINIT, OS_STKCHECK and default stack size, as in RTX_CM_lib.h */
+extern const uint32_t os_stackinfo;
+const uint32_t os_stackinfo = (1u << 28) | (1u << 24) | (OS_SIM_STKSIZE * 4);
+
+
+struct os_mutex_cb
+{
+	struct os_thread_cb *owner;
+	uint32_t count;
+	uint8_t used;
+};
+
+struct os_timer_cb
+{
+	const osTimerDef_t *def;
+	void *arg;
+	os_timer_type type;
+	uint32_t period;
+	uint32_t expire;
+	uint8_t used;
+	uint8_t active;
+};
+
+struct os_thread_cb
+{
+	ucontext_t ctx;
+	os_sim_thread_t info;
+	os_pthread fn;
+	void *arg;
+	char *stack;
+	int32_t signals;
+	int32_t sig_wait;
+	int32_t sig_got;
+	uint32_t wake;								/* tick, or OS_SIM_FOREVER */
+	uint8_t timed_out;
+	uint32_t seq;									/* order among equal priorities */
+	uint32_t slice;
+	struct os_mutex_cb *mutex;
+};
+
+
+/** Local variables */
+static struct os_thread_cb threads[OS_SIM_THREADS];
+static struct os_mutex_cb mutexes[OS_SIM_MUTEXES];
+static struct os_timer_cb timers[OS_SIM_TIMERS];
+static struct os_timer_cb *timer_q[OS_SIM_TIMERCBQS];
+static uint8_t timer_qin, timer_qout, timer_qcnt;
+static struct os_thread_cb *timer_thread;
+static struct os_thread_cb *cur;
+static uint8_t nthreads;
+
+uint32_t os_time;												/* as in RTX rt_Time.c, read by trace.c */
+static sim_time_t tick_at;
+static uint32_t ready_seq;
+static uint8_t inited, running, need_resched, in_kernel;
+
+static sim_time_t acct_mark, acct_isr;
+static sim_time_t idle_cycles, kernel_cycles;
+
+static void os_hook(void);
+static void os_timer_thread(void const *argument);
+
+
+/**
+  * Charge time since the last mark to a counter, without interrupts
+  */
+static void os_account(sim_time_t *to)
+{
+	sim_time_t isr = Sim_IsrCycles();
+
+	*to += (Sim_Cycles - acct_mark) - (isr - acct_isr);
+	acct_mark = Sim_Cycles;
+	acct_isr = isr;
+}
+
+
+/**
+  * SysTick VAL counts down from LOAD each tick; PENDSTSET while a tick is
+  * due but not yet run
+  */
+static void os_systick_read(void *ctx, SimReg *reg)
+{
+	if (reg == &Sim_SysTick.VAL)
+		reg->v = (uint32_t)(OS_SIM_TICK_CYCLES - 1 - Sim_Cycles % OS_SIM_TICK_CYCLES);
+	else if ((uint32_t)(Sim_Cycles / OS_SIM_TICK_CYCLES) != os_time)
+		reg->v |= SCB_ICSR_PENDSTSET_Msk;
+	else
+		reg->v &= ~SCB_ICSR_PENDSTSET_Msk;
+}
+
+
+static void os_init(void)
+{
+	if (inited) return;
+	inited = 1;
+
+	cur = &threads[0];
+	cur->info.name = "main";
+	cur->info.prio = osPriorityNormal;
+	cur->info.state = OS_SIM_RUNNING;
+	cur->info.switches = 1;
+	cur->info.stacksize = OS_SIM_STKSIZE * 4;
+	cur->wake = OS_SIM_FOREVER;
+	nthreads = 1;
+
+	os_time = (uint32_t)(Sim_Cycles / OS_SIM_TICK_CYCLES);
+	tick_at = (sim_time_t)(os_time + 1) * OS_SIM_TICK_CYCLES;
+	Sim_SysTick.LOAD.v = (uint32_t)(OS_SIM_TICK_CYCLES - 1);
+	Sim_SysTick.CTRL.v = SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_CLKSOURCE_Msk;
+	Sim_ReadHook(&Sim_SysTick.VAL, os_systick_read, NULL);
+	Sim_ReadHook(&Sim_SCB.ICSR, os_systick_read, NULL);
+	acct_mark = Sim_Cycles;
+	acct_isr = Sim_IsrCycles();
+	Sim_CpuHook(os_hook);
+}
+
+
+/**
+  * Milliseconds to ticks, rounded up and limited as in RTX rt_ms2tick()
+  */
+static uint32_t os_ms2tick(uint32_t millisec)
+{
+	uint64_t tick;
+
+	if (millisec == osWaitForever) return OS_SIM_FOREVER;
+	tick = ((uint64_t)millisec * 1000 + OS_SIM_TICK - 1) / OS_SIM_TICK;
+	if (tick > 0xFFFE) tick = 0xFFFE;
+	return (uint32_t)tick;
+}
+
+
+static void os_ready(struct os_thread_cb *t)
+{
+	if (t->info.state >= OS_SIM_WAIT_DLY) t->info.wakeups++;
+	t->info.state = OS_SIM_READY;
+	t->seq = ++ready_seq;
+	if (running && (t->info.prio > cur->info.prio)) need_resched = 1;
+}
+
+
+/**
+  * Highest priority ready thread; among equals the one waiting longest.
+  * Before osKernelStart() only main runs.
+  */
+static struct os_thread_cb *os_next(void)
+{
+	struct os_thread_cb *t, *best = 0;
+	uint8_t i;
+
+	for (i = 0; i < nthreads; i++)
+	{
+		t = &threads[i];
+		if ((t->info.state != OS_SIM_READY) && (t->info.state != OS_SIM_RUNNING)) continue;
+		if (!running && (i != 0)) continue;
+		if ((best == 0) || (t->info.prio > best->info.prio) ||
+		    ((t->info.prio == best->info.prio) && (t->seq < best->seq))) best = t;
+	}
+	return best;
+}
+
+
+/**
+  * Process elapsed ticks: delays, timeouts, timers and round robin
+  */
+static void os_tick(uint8_t isr)
+{
+	uint32_t now = (uint32_t)(Sim_Cycles / OS_SIM_TICK_CYCLES);
+	uint32_t elapsed;
+	struct os_thread_cb *t;
+	struct os_timer_cb *tm;
+	uint8_t i, post = 0;
+
+	if (now == os_time) return;
+	elapsed = now - os_time;
+	os_time = now;
+	tick_at = (sim_time_t)(now + 1) * OS_SIM_TICK_CYCLES;
+
+	if (isr)
+	{
+		in_kernel++;
+		Sim_IsrEnter();
+		Sim_Advance(OS_SIM_TICKISR_CYCLES);
+		Sim_IsrExit();
+		in_kernel--;
+	}
+
+	for (i = 0; i < nthreads; i++)
+	{
+		t = &threads[i];
+		if ((t->info.state < OS_SIM_WAIT_DLY) || (t->wake == OS_SIM_FOREVER)) continue;
+		if ((int32_t)(os_time - t->wake) < 0) continue;
+		t->timed_out = 1;
+		t->mutex = 0;
+		os_ready(t);
+	}
+
+	for (i = 0; i < OS_SIM_TIMERS; i++)
+	{
+		tm = &timers[i];
+		if (!tm->active || ((int32_t)(os_time - tm->expire) < 0)) continue;
+		if (timer_qcnt < OS_SIM_TIMERCBQS)
+		{
+			timer_q[timer_qin] = tm;
+			timer_qin = (uint8_t)((timer_qin + 1) % OS_SIM_TIMERCBQS);
+			timer_qcnt++;
+			post = 1;
+		}
+		if (tm->type == osTimerPeriodic)
+		{
+			while ((int32_t)(os_time - tm->expire) >= 0) tm->expire += tm->period;
+		}
+		else
+			tm->active = 0;
+	}
+	if (post && timer_thread && (timer_thread->info.state == OS_SIM_WAIT_SIG))
+	{
+		timer_thread->sig_got = OS_SIM_TIMERSIG;
+		timer_thread->timed_out = 0;
+		os_ready(timer_thread);
+	}
+
+	/* round robin among equal priorities */
+	if (OS_SIM_ROBIN && running && (cur->info.state == OS_SIM_RUNNING))
+	{
+		if (cur->slice > elapsed)
+			cur->slice -= elapsed;
+		else
+		{
+			cur->slice = 0;
+			for (i = 0; i < nthreads; i++)
+			{
+				t = &threads[i];
+				if ((t != cur) && (t->info.state == OS_SIM_READY) && (t->info.prio == cur->info.prio))
+				{
+					cur->seq = ++ready_seq;
+					need_resched = 1;
+					break;
+				}
+			}
+		}
+	}
+}
+
+
+/**
+  * Nothing to run: jump to the next point where something can happen
+  */
+static void os_idle(void)
+{
+	sim_time_t t = Sim_NextEvent();
+	sim_time_t w, t0;
+	uint32_t wake = OS_SIM_FOREVER;
+	uint32_t d, dmin = OS_SIM_FOREVER;
+	uint8_t i;
+
+	for (i = 0; i < nthreads; i++)
+	{
+		if ((threads[i].info.state < OS_SIM_WAIT_DLY) || (threads[i].wake == OS_SIM_FOREVER)) continue;
+		d = threads[i].wake - os_time;
+		if (d < dmin) { dmin = d; wake = threads[i].wake; }
+	}
+	for (i = 0; i < OS_SIM_TIMERS; i++)
+	{
+		if (!timers[i].active) continue;
+		d = timers[i].expire - os_time;
+		if (d < dmin) { dmin = d; wake = timers[i].expire; }
+	}
+	if (wake != OS_SIM_FOREVER)
+	{
+		w = (sim_time_t)wake * OS_SIM_TICK_CYCLES;
+		if (w < t) t = w;
+	}
+	if (t == SIM_NEVER)
+	{
+		fprintf(stderr, "os_sim: all threads blocked forever at %.3f ms\n", Sim_Us(Sim_Cycles) / 1000.0);
+		OS_SimReport(stderr);
+		exit(2);
+	}
+
+	t0 = Sim_Cycles;
+	Sim_AdvanceTo(t);
+	Load_Idle((uint32_t)Sim_Us(Sim_Cycles - t0));		/* os_idle_demon() asleep */
+	os_tick(0);
+	os_account(&idle_cycles);
+}
+
+
+/**
+  * Give the CPU to the best ready thread, which may be the current one
+  */
+static void os_dispatch(void)
+{
+	struct os_thread_cb *prev = cur;
+	struct os_thread_cb *next;
+
+	in_kernel++;
+	need_resched = 0;
+	os_account(&prev->info.cycles);
+
+	while ((next = os_next()) == 0) os_idle();
+
+	if (next != prev)
+	{
+		Sim_Advance(OS_SIM_SWITCH_CYCLES);
+		os_account(&kernel_cycles);
+		if (prev->info.state == OS_SIM_RUNNING) prev->info.state = OS_SIM_READY;
+		next->info.state = OS_SIM_RUNNING;
+		next->info.switches++;
+		next->slice = OS_SIM_ROBINTOUT;
+		cur = next;
+		swapcontext(&prev->ctx, &next->ctx);
+	}
+	else if (next->info.state != OS_SIM_RUNNING)
+	{
+		next->info.state = OS_SIM_RUNNING;
+		next->slice = OS_SIM_ROBINTOUT;
+	}
+	in_kernel--;
+}
+
+
+static void os_resched(void)
+{
+	if (need_resched && !in_kernel && !Sim_InIsr()) os_dispatch();
+}
+
+
+/**
+  * Called by the simulator after each advance of time in thread context
+  */
+static void os_hook(void)
+{
+	if (in_kernel) return;
+	if (Sim_Cycles >= tick_at) os_tick(1);
+	if (need_resched) os_dispatch();
+}
+
+
+/**
+  * Block the current thread; returns 1 on timeout
+  */
+static uint8_t os_block(uint8_t state, uint32_t ticks)
+{
+	cur->info.state = state;
+	cur->wake = (ticks == OS_SIM_FOREVER) ? OS_SIM_FOREVER : os_time + ticks;
+	cur->timed_out = 0;
+	os_dispatch();
+	return cur->timed_out;
+}
+
+
+static void os_enter(void)
+{
+	os_init();
+	if (!Sim_InIsr()) Sim_Advance(OS_SIM_SVC_CYCLES);
+}
+
+
+static void os_thread_entry(void)
+{
+	in_kernel--;
+	cur->fn(cur->arg);
+	osThreadTerminate(cur);
+}
+
+
+/*----------------------------------------------------------------------------
+ *      Kernel
+ *---------------------------------------------------------------------------*/
+osStatus osKernelInitialize (void)
+{
+	os_init();
+	return osOK;
+}
+
+
+osStatus osKernelStart (void)
+{
+	os_enter();
+	running = 1;
+	need_resched = 1;
+	os_resched();
+	return osOK;
+}
+
+
+int32_t osKernelRunning (void)
+{
+	return running;
+}
+
+
+uint32_t osKernelSysTick (void)
+{
+	return (uint32_t)Sim_Cycles;
+}
+
+
+/*----------------------------------------------------------------------------
+ *      Threads
+ *---------------------------------------------------------------------------*/
+osThreadId osThreadCreate (const osThreadDef_t *thread_def, void *argument)
+{
+	struct os_thread_cb *t;
+
+	os_enter();
+	if ((thread_def == NULL) || (nthreads == OS_SIM_THREADS)) return NULL;
+
+	t = &threads[nthreads++];
+	t->info.name = thread_def->name;
+	t->info.prio = thread_def->tpriority;
+	t->info.stacksize = thread_def->stacksize ? thread_def->stacksize : OS_SIM_STKSIZE * 4;
+	t->fn = thread_def->pthread;
+	t->arg = argument;
+	t->wake = OS_SIM_FOREVER;
+	t->stack = (char *)malloc(OS_SIM_HOSTSTACK);
+
+	getcontext(&t->ctx);
+	t->ctx.uc_stack.ss_sp = t->stack;
+	t->ctx.uc_stack.ss_size = OS_SIM_HOSTSTACK;
+	t->ctx.uc_link = NULL;
+	makecontext(&t->ctx, os_thread_entry, 0);
+
+	os_ready(t);
+	os_resched();
+	return t;
+}
+
+
+osThreadId osThreadGetId (void)
+{
+	os_init();
+	return cur;
+}
+
+
+osStatus osThreadTerminate (osThreadId thread_id)
+{
+	if (thread_id == NULL) return osErrorParameter;
+	os_enter();
+	thread_id->info.state = OS_SIM_INACTIVE;
+	if (thread_id == cur) os_dispatch();
+	return osOK;
+}
+
+
+osStatus osThreadYield (void)
+{
+	os_enter();
+	cur->seq = ++ready_seq;
+	os_dispatch();
+	return osOK;
+}
+
+
+osStatus osThreadSetPriority (osThreadId thread_id, osPriority priority)
+{
+	if (thread_id == NULL) return osErrorParameter;
+	os_enter();
+	thread_id->info.prio = priority;
+	need_resched = running;
+	os_resched();
+	return osOK;
+}
+
+
+osPriority osThreadGetPriority (osThreadId thread_id)
+{
+	return thread_id ? thread_id->info.prio : osPriorityError;
+}
+
+
+/*----------------------------------------------------------------------------
+ *      Generic wait
+ *---------------------------------------------------------------------------*/
+osStatus osDelay (uint32_t millisec)
+{
+	if (Sim_InIsr()) return osErrorISR;
+	os_enter();
+	os_block(OS_SIM_WAIT_DLY, os_ms2tick(millisec));
+	return osEventTimeout;
+}
+
+
+/*----------------------------------------------------------------------------
+ *      Signals
+ *---------------------------------------------------------------------------*/
+
+/**
+  * Signals that satisfy a wait, cleared when taken. 0 waits for any.
+  */
+static int32_t os_sig_take(struct os_thread_cb *t, int32_t mask)
+{
+	int32_t got;
+
+	if (mask == 0)
+		got = t->signals;
+	else
+		got = ((t->signals & mask) == mask) ? mask : 0;
+	t->signals &= ~got;
+	return got;
+}
+
+
+int32_t osSignalSet (osThreadId thread_id, int32_t signals)
+{
+	int32_t prev;
+	int32_t got;
+
+	if (thread_id == NULL) return (int32_t)0x80000000;
+	os_enter();
+	prev = thread_id->signals;
+	thread_id->signals |= signals;
+	if (thread_id->info.state == OS_SIM_WAIT_SIG)
+	{
+		got = os_sig_take(thread_id, thread_id->sig_wait);
+		if (got)
+		{
+			thread_id->sig_got = got;
+			thread_id->timed_out = 0;
+			os_ready(thread_id);
+		}
+	}
+	os_resched();
+	return prev;
+}
+
+
+int32_t osSignalClear (osThreadId thread_id, int32_t signals)
+{
+	int32_t prev;
+
+	if (thread_id == NULL) return (int32_t)0x80000000;
+	prev = thread_id->signals;
+	thread_id->signals &= ~signals;
+	return prev;
+}
+
+
+osEvent osSignalWait (int32_t signals, uint32_t millisec)
+{
+	osEvent evt;
+	int32_t got;
+
+	evt.value.signals = 0;
+	if (Sim_InIsr())
+	{
+		evt.status = osErrorISR;
+		return evt;
+	}
+	os_enter();
+
+	got = os_sig_take(cur, signals);
+	if (got)
+	{
+		evt.status = osEventSignal;
+		evt.value.signals = got;
+		return evt;
+	}
+	if (millisec == 0)
+	{
+		evt.status = osOK;
+		return evt;
+	}
+
+	cur->sig_wait = signals;
+	if (os_block(OS_SIM_WAIT_SIG, os_ms2tick(millisec)))
+		evt.status = osEventTimeout;
+	else
+	{
+		evt.status = osEventSignal;
+		evt.value.signals = cur->sig_got;
+	}
+	return evt;
+}
+
+
+/*----------------------------------------------------------------------------
+ *      Mutexes
+ *---------------------------------------------------------------------------*/
+osMutexId osMutexCreate (const osMutexDef_t *mutex_def)
+{
+	uint8_t i;
+
+	os_enter();
+	for (i = 0; i < OS_SIM_MUTEXES; i++)
+	{
+		if (!mutexes[i].used)
+		{
+			mutexes[i].used = 1;
+			mutexes[i].owner = 0;
+			mutexes[i].count = 0;
+			return &mutexes[i];
+		}
+	}
+	return NULL;
+}
+
+
+osStatus osMutexWait (osMutexId mutex_id, uint32_t millisec)
+{
+	if (mutex_id == NULL) return osErrorParameter;
+	if (Sim_InIsr()) return osErrorISR;
+	os_enter();
+
+	if ((mutex_id->owner == 0) || (mutex_id->owner == cur))
+	{
+		mutex_id->owner = cur;
+		mutex_id->count++;
+		return osOK;
+	}
+	if (millisec == 0) return osErrorResource;
+
+	cur->mutex = mutex_id;
+	if (os_block(OS_SIM_WAIT_MUT, os_ms2tick(millisec))) return osErrorTimeoutResource;
+	return osOK;
+}
+
+
+osStatus osMutexRelease (osMutexId mutex_id)
+{
+	struct os_thread_cb *t, *w = 0;
+	uint8_t i;
+
+	if (mutex_id == NULL) return osErrorParameter;
+	if (Sim_InIsr()) return osErrorISR;
+	os_enter();
+	if (mutex_id->owner != cur) return osErrorResource;
+	if (--mutex_id->count) return osOK;
+
+	/* hand over to the highest priority waiter */
+	for (i = 0; i < nthreads; i++)
+	{
+		t = &threads[i];
+		if ((t->info.state == OS_SIM_WAIT_MUT) && (t->mutex == mutex_id) &&
+		    ((w == 0) || (t->info.prio > w->info.prio))) w = t;
+	}
+	mutex_id->owner = w;
+	if (w)
+	{
+		mutex_id->count = 1;
+		w->mutex = 0;
+		w->timed_out = 0;
+		os_ready(w);
+	}
+	os_resched();
+	return osOK;
+}
+
+
+osStatus osMutexDelete (osMutexId mutex_id)
+{
+	if (mutex_id == NULL) return osErrorParameter;
+	mutex_id->used = 0;
+	return osOK;
+}
+
+
+/*----------------------------------------------------------------------------
+ *      Timers: callbacks run in a timer thread at OS_TIMERPRIO
+ *---------------------------------------------------------------------------*/
+static void os_timer_thread(void const *argument)
+{
+	struct os_timer_cb *tm;
+
+	while (1)
+	{
+		osSignalWait(OS_SIM_TIMERSIG, osWaitForever);
+		while (timer_qcnt)
+		{
+			tm = timer_q[timer_qout];
+			timer_qout = (uint8_t)((timer_qout + 1) % OS_SIM_TIMERCBQS);
+			timer_qcnt--;
+			tm->def->ptimer(tm->arg);
+		}
+	}
+}
+
+static const osThreadDef_t os_thread_def_timer = { os_timer_thread, OS_SIM_TIMERPRIO, 1, 0, "osTimerThread" };
+
+
+osTimerId osTimerCreate (const osTimerDef_t *timer_def, os_timer_type type, void *argument)
+{
+	uint8_t i;
+
+	os_enter();
+	if (timer_thread == NULL) timer_thread = osThreadCreate(&os_thread_def_timer, NULL);
+	for (i = 0; i < OS_SIM_TIMERS; i++)
+	{
+		if (!timers[i].used)
+		{
+			memset(&timers[i], 0, sizeof(timers[i]));
+			timers[i].used = 1;
+			timers[i].def = timer_def;
+			timers[i].arg = argument;
+			timers[i].type = type;
+			return &timers[i];
+		}
+	}
+	return NULL;
+}
+
+
+osStatus osTimerStart (osTimerId timer_id, uint32_t millisec)
+{
+	uint32_t ticks;
+
+	if ((timer_id == NULL) || (millisec == 0)) return osErrorParameter;
+	os_enter();
+	ticks = os_ms2tick(millisec);
+	timer_id->period = ticks;
+	timer_id->expire = os_time + ticks;
+	timer_id->active = 1;
+	return osOK;
+}
+
+
+osStatus osTimerStop (osTimerId timer_id)
+{
+	if (timer_id == NULL) return osErrorParameter;
+	os_enter();
+	if (!timer_id->active) return osErrorResource;
+	timer_id->active = 0;
+	return osOK;
+}
+
+
+osStatus osTimerDelete (osTimerId timer_id)
+{
+	if (timer_id == NULL) return osErrorParameter;
+	timer_id->active = 0;
+	timer_id->used = 0;
+	return osOK;
+}
+
+
+/*----------------------------------------------------------------------------
+ *      Simulation control and accounting
+ *---------------------------------------------------------------------------*/
+static void os_runfor_done(void *ctx)
+{
+	struct os_thread_cb *t = (struct os_thread_cb *)ctx;
+
+	if (t->info.state == OS_SIM_WAIT_DLY) os_ready(t);
+}
+
+
+void OS_SimRunFor(sim_time_t cycles)
+{
+	os_init();
+	Sim_Schedule(Sim_Cycles + cycles, os_runfor_done, cur);
+	os_block(OS_SIM_WAIT_DLY, OS_SIM_FOREVER);
+}
+
+
+uint32_t OS_SimTick(void)
+{
+	return os_time;
+}
+
+
+uint8_t OS_SimThreadCount(void)
+{
+	os_init();
+	return nthreads;
+}
+
+
+const os_sim_thread_t *OS_SimThread(uint8_t i)
+{
+	if (i >= nthreads) return NULL;
+	if ((&threads[i] == cur) && !Sim_InIsr() && !in_kernel) os_account(&cur->info.cycles);
+	return &threads[i].info;
+}
+
+
+sim_time_t OS_SimIdleCycles(void)
+{
+	return idle_cycles;
+}
+
+
+sim_time_t OS_SimKernelCycles(void)
+{
+	return kernel_cycles;
+}
+
+
+void OS_SimReport(FILE *f)
+{
+	static const char *state[] = { "inactive", "ready", "running", "delay", "signal", "mutex" };
+	const os_sim_thread_t *t;
+	double total = (double)(Sim_Cycles ? Sim_Cycles : 1);
+	uint8_t i;
+
+	fprintf(f, "%-20s %5s %-8s %12s %7s %9s %9s\n", "thread", "prio", "state", "cpu ms", "cpu %", "switches", "wakeups");
+	for (i = 0; i < OS_SimThreadCount(); i++)
+	{
+		t = OS_SimThread(i);
+		fprintf(f, "%-20s %5d %-8s %12.3f %7.2f %9u %9u\n", t->name, (int)t->prio, state[t->state],
+		        Sim_Us(t->cycles) / 1000.0, 100.0 * (double)t->cycles / total, t->switches, t->wakeups);
+	}
+	fprintf(f, "%-20s %5s %-8s %12.3f %7.2f\n", "(interrupts)", "", "", Sim_Us(Sim_IsrCycles()) / 1000.0, 100.0 * (double)Sim_IsrCycles() / total);
+	fprintf(f, "%-20s %5s %-8s %12.3f %7.2f\n", "(kernel)", "", "", Sim_Us(kernel_cycles) / 1000.0, 100.0 * (double)kernel_cycles / total);
+	fprintf(f, "%-20s %5s %-8s %12.3f %7.2f\n", "(idle)", "", "", Sim_Us(idle_cycles) / 1000.0, 100.0 * (double)idle_cycles / total);
+	fprintf(f, "virtual time %.3f ms, %u ticks\n", Sim_Us(Sim_Cycles) / 1000.0, os_time);
+}
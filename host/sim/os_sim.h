@@ -0,0 +1,59 @@
+/**
+ * @file     os_sim.h
+ * @brief    CMSIS-RTOS v1 kernel for the host simulation
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Threads are ucontext coroutines in one host thread, scheduled
+ *           as RTX does it: highest ready priority first, round robin
+ *           among equal priorities, preemption at any register access.
+ *           Kernel time is the virtual clock, so waits with nothing to run
+ *           skip ahead to the next wakeup instead of spinning.
+ *
+ *           Tick period and round robin timeout mirror
+ *           rte/CMSIS/RTX_Conf_CM.c. The host main() is the RTX main
+ *           thread.
+ *
+ */
+
+#ifndef ___OS_SIM_H_
+#define ___OS_SIM_H_
+
+#include "cmsis_os.h"
+#include "sim.h"
+#include <stdio.h>
+
+/** \brief Thread accounting */
+typedef struct
+{
+	const char *name;
+	osPriority prio;
+	uint8_t state;							/*!< OS_SIM_xxx */
+	uint64_t cycles;						/*!< CPU time, interrupts excluded */
+	uint32_t switches;					/*!< times it got the CPU */
+	uint32_t wakeups;						/*!< times it left a wait */
+	uint32_t stacksize;					/*!< requested, bytes */
+} os_sim_thread_t;
+
+#define OS_SIM_INACTIVE		0
+#define OS_SIM_READY			1
+#define OS_SIM_RUNNING		2
+#define OS_SIM_WAIT_DLY		3
+#define OS_SIM_WAIT_SIG		4
+#define OS_SIM_WAIT_MUT		5
+
+/** Run all other threads for a stretch of virtual time. Called from the
+ *  host main thread, which should have the highest priority. */
+void OS_SimRunFor(sim_time_t cycles);
+
+/** Kernel tick count */
+uint32_t OS_SimTick(void);
+
+/** Accounting */
+uint8_t OS_SimThreadCount(void);
+const os_sim_thread_t *OS_SimThread(uint8_t i);
+sim_time_t OS_SimIdleCycles(void);
+sim_time_t OS_SimKernelCycles(void);
+void OS_SimReport(FILE *f);
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file     sim.h
+ * @brief    Host simulation of the STM32F0 register layer
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Firmware sources are compiled unchanged as C++ against
+ *           host/include/stm32f0xx.h. Every peripheral register is a
+ *           SimReg object, so each access is seen here: GPIO output changes
+ *           are recorded as pin transitions with a timestamp and passed to
+ *           listeners (device models, probes).
+ *
+ *           Time is virtual and counted in core clock cycles. It advances
+ *           only by register accesses, __nop() and RTOS delays, so results
+ *           do not depend on the speed of the host. Device models and
+ *           stimuli schedule events on the same clock; interrupts are
+ *           delivered to the firmware's IRQ handlers between accesses.
+ *
+ */
+
+#ifndef ___SIM_H_
+#define ___SIM_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+/** \brief Simulated core clock, Hz */
+#define SIM_CORE_HZ				48000000UL
+
+/** \brief Cycles charged for one peripheral register access */
+#define SIM_REG_CYCLES		2
+
+/** \brief Cycles charged for __nop(), including the surrounding delay loop */
+#define SIM_NOP_CYCLES		4
+
+/** \brief Cycles charged for interrupt entry and exit */
+#define SIM_IRQ_CYCLES		16
+
+/** \brief No event scheduled */
+#define SIM_NEVER				((sim_time_t)-1)
+
+/** \brief GPIO port index */
+#define SIM_PORTA		0
+#define SIM_PORTB		1
+#define SIM_PORTC		2
+#define SIM_PORTD		3
+#define SIM_PORTE		4
+#define SIM_PORTF		5
+#define SIM_NPORTS	6
+
+typedef uint64_t sim_time_t;
+
+/** \brief Pin transition callback: level is the new output level */
+typedef void (*sim_pin_cb_t)(void *ctx, uint8_t port, uint8_t pin, uint8_t level, sim_time_t t);
+
+/** \brief Recorded pin transition */
+typedef struct
+{
+	sim_time_t t;
+	uint8_t port;
+	uint8_t pin;
+	uint8_t level;
+} sim_edge_t;
+
+/** \brief Access and transition counters */
+typedef struct
+{
+	uint64_t reg_reads;
+	uint64_t reg_writes;
+	uint64_t nops;
+	uint64_t blocks;								/*!< firmware basic blocks run, see Makefile */
+	uint64_t edges;									/*!< all pin transitions */
+	uint64_t irqs;									/*!< interrupt handlers run */
+	uint32_t rise[SIM_NPORTS][16];		/*!< rising edges per pin */
+	uint32_t fall[SIM_NPORTS][16];		/*!< falling edges per pin */
+} sim_stats_t;
+
+
+/** Virtual time */
+extern sim_time_t Sim_Cycles;
+void Sim_Advance(uint64_t cycles);
+void Sim_AdvanceTo(sim_time_t t);
+double Sim_Us(sim_time_t cycles);
+#define SIM_US(us)		((sim_time_t)(us) * (SIM_CORE_HZ / 1000000))
+
+/** Timed events: cb runs when virtual time reaches t */
+typedef void (*sim_event_cb_t)(void *ctx);
+uint32_t Sim_Schedule(sim_time_t t, sim_event_cb_t cb, void *ctx);
+void Sim_Cancel(uint32_t id);
+sim_time_t Sim_NextEvent(void);
+
+/** Interrupt context. Handlers run with Sim_InIsr() != 0, and their time is
+ *  summed in Sim_IsrCycles(). */
+void Sim_IsrEnter(void);
+void Sim_IsrExit(void);
+uint8_t Sim_InIsr(void);
+sim_time_t Sim_IsrCycles(void);
+
+/** Called after every advance of time outside events and interrupts; the
+ *  RTOS uses it for its tick and for preemption. */
+void Sim_CpuHook(void (*hook)(void));
+
+/** Reset all peripherals, time and counters */
+void Sim_Reset(void);
+
+/** GPIO */
+void Sim_PinListen(uint8_t port, uint16_t mask, sim_pin_cb_t cb, void *ctx);
+void Sim_SetInput(uint8_t port, uint8_t pin, uint8_t level);
+uint8_t Sim_GetOutput(uint8_t port, uint8_t pin);
+
+/** Counters */
+const sim_stats_t *Sim_Stats(void);
+void Sim_ClearStats(void);
+
+/** Transition log (disabled by default) */
+void Sim_LogEnable(uint8_t on);
+uint32_t Sim_LogCount(void);
+const sim_edge_t *Sim_LogGet(uint32_t i);
+void Sim_LogWriteVCD(FILE *f);
+
+/** Device read hook: called before a register is read, may update it */
+struct SimReg;
+typedef void (*sim_read_cb_t)(void *ctx, struct SimReg *reg);
+void Sim_ReadHook(struct SimReg *reg, sim_read_cb_t cb, void *ctx);
+
+#endif
@@ -0,0 +1,796 @@
+/**
+  ******************************************************************************
+  * @file    sim_regs.cpp
+  * @author  e.pavlin.si
+  * @brief   Simulated STM32F0 register layer: GPIO, RCC, EXTI, SYSCFG, ...
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * Each register access costs SIM_REG_CYCLES of virtual time. Registers
+  * with side effects are modelled as on the device:
+  *
+  *   GPIOx->BSRR/BRR   set/reset ODR bits, write only
+  *   GPIOx->IDR        output pins read back ODR, inputs from Sim_SetInput()
+  *   EXTI->PR          rc_w1, writing 1 clears the pending bit
+  *   EXTI lines        input edges set PR and pend the NVIC line
+  *   RCC, ADC          ready flags follow their enable bits immediately
+  *
+  * All other registers behave as plain memory.
+  *
+  */
+
+#include "stm32f0xx.h"
+#include "sim.h"
+#include <string.h>
+#include <vector>
+
+
+/** Peripheral instances */
+GPIO_TypeDef Sim_GPIO[6];
+RCC_TypeDef Sim_RCC;
+EXTI_TypeDef Sim_EXTI;
+SYSCFG_TypeDef Sim_SYSCFG;
+ADC_TypeDef Sim_ADC1;
+ADC_Common_TypeDef Sim_ADC;
+DMA_TypeDef Sim_DMA1;
+DMA_Channel_TypeDef Sim_DMA1_Channel[5];
+TIM_TypeDef Sim_TIM3, Sim_TIM14, Sim_TIM16, Sim_TIM17;
+SysTick_Type Sim_SysTick;
+SCB_Type Sim_SCB;
+PWR_TypeDef Sim_PWR;
+FLASH_TypeDef Sim_FLASH;
+
+uint32_t SystemCoreClock = SIM_CORE_HZ;
+
+sim_time_t Sim_Cycles;
+
+
+/** Local variables */
+typedef struct
+{
+	sim_pin_cb_t cb;
+	void *ctx;
+	uint8_t port;
+	uint16_t mask;
+} sim_listener_t;
+
+typedef struct
+{
+	const SimReg *reg;
+	sim_read_cb_t cb;
+	void *ctx;
+} sim_hook_t;
+
+typedef struct
+{
+	sim_time_t t;
+	sim_event_cb_t cb;
+	void *ctx;
+	uint32_t id;
+} sim_event_t;
+
+static sim_stats_t stats;
+static uint16_t pin_in[SIM_NPORTS];               // external input levels
+static std::vector<sim_listener_t> listeners;
+static std::vector<sim_hook_t> read_hooks;
+static std::vector<sim_edge_t> edge_log;
+static uint8_t log_on;
+static uint8_t in_hook;
+static std::vector<sim_event_t> events;
+static sim_time_t next_event = SIM_NEVER;
+static uint32_t event_id;
+static uint8_t in_event;
+static uint8_t isr_depth;
+static sim_time_t isr_start, isr_cycles;
+static void (*cpu_hook)(void);
+static uint32_t nvic_enabled, nvic_pending;
+static uint8_t nvic_prio[32];
+static uint32_t primask;
+
+static void Sim_IrqService(void);
+
+
+/** Register of a block, by address */
+template <class T> static bool Sim_In(const SimReg *r, const T *blk, size_t n = 1)
+{
+	return ((const char *)r >= (const char *)blk) && ((const char *)r < (const char *)(blk + n));
+}
+
+#define SIM_REG_IS(r, blk, field)		((r) == &(blk).field)
+
+
+static void Sim_NextUpdate(void)
+{
+	size_t i;
+
+	next_event = SIM_NEVER;
+	for (i = 0; i < events.size(); i++)
+		if (events[i].t < next_event) next_event = events[i].t;
+}
+
+
+/**
+  * Run events due up to target, each at its own time
+  */
+static void Sim_RunEvents(sim_time_t target)
+{
+	sim_event_t e;
+	size_t i, first;
+
+	in_event = 1;
+	while (next_event <= target)
+	{
+		first = 0;
+		for (i = 1; i < events.size(); i++)
+			if (events[i].t < events[first].t) first = i;
+		e = events[first];
+		events.erase(events.begin() + first);
+		Sim_NextUpdate();
+		if (e.t > Sim_Cycles) Sim_Cycles = e.t;
+		e.cb(e.ctx);
+	}
+	in_event = 0;
+}
+
+
+void Sim_Advance(uint64_t cycles)
+{
+	sim_time_t target = Sim_Cycles + cycles;
+
+	if ((next_event <= target) && !in_event) Sim_RunEvents(target);
+	if (target > Sim_Cycles) Sim_Cycles = target;
+	if (cpu_hook && !in_event && !isr_depth) cpu_hook();
+}
+
+
+/**
+  * Advance to t. An interrupt run from an event can take the clock past
+  * other events; a t already passed still runs those.
+  */
+void Sim_AdvanceTo(sim_time_t t)
+{
+	Sim_Advance((t > Sim_Cycles) ? t - Sim_Cycles : 0);
+}
+
+
+uint32_t Sim_Schedule(sim_time_t t, sim_event_cb_t cb, void *ctx)
+{
+	sim_event_t e;
+
+	e.t = t;
+	e.cb = cb;
+	e.ctx = ctx;
+	e.id = ++event_id;
+	events.push_back(e);
+	if (t < next_event) next_event = t;
+	return e.id;
+}
+
+
+void Sim_Cancel(uint32_t id)
+{
+	size_t i;
+
+	for (i = 0; i < events.size(); i++)
+	{
+		if (events[i].id == id)
+		{
+			events.erase(events.begin() + i);
+			Sim_NextUpdate();
+			return;
+		}
+	}
+}
+
+
+sim_time_t Sim_NextEvent(void)
+{
+	return next_event;
+}
+
+
+void Sim_CpuHook(void (*hook)(void))
+{
+	cpu_hook = hook;
+}
+
+
+double Sim_Us(sim_time_t cycles)
+{
+	return (double)cycles * 1e6 / (double)SIM_CORE_HZ;
+}
+
+
+/**
+  * Output data register changed: record and report transitions
+  */
+static void Sim_GpioOut(uint8_t port, uint32_t old_odr, uint32_t new_odr)
+{
+	uint32_t diff = (old_odr ^ new_odr) & 0xFFFF;
+	uint8_t pin, level;
+	size_t i;
+	sim_edge_t e;
+
+	for (pin = 0; diff; pin++, diff >>= 1)
+	{
+		if ((diff & 1) == 0) continue;
+		level = (uint8_t)((new_odr >> pin) & 1);
+		stats.edges++;
+		if (level) stats.rise[port][pin]++; else stats.fall[port][pin]++;
+		if (log_on)
+		{
+			e.t = Sim_Cycles;
+			e.port = port;
+			e.pin = pin;
+			e.level = level;
+			edge_log.push_back(e);
+		}
+		for (i = 0; i < listeners.size(); i++)
+		{
+			if ((listeners[i].port == port) && (listeners[i].mask & (1u << pin)))
+			{
+				listeners[i].cb(listeners[i].ctx, port, pin, level, Sim_Cycles);
+			}
+		}
+	}
+}
+
+
+/**
+  * Pin level as seen on IDR: output mode pins read back ODR
+  */
+static uint32_t Sim_GpioIDR(uint8_t port)
+{
+	GPIO_TypeDef *g = &Sim_GPIO[port];
+	uint32_t idr = 0;
+	uint8_t pin, mode;
+
+	for (pin = 0; pin < 16; pin++)
+	{
+		mode = (uint8_t)((g->MODER.v >> (2 * pin)) & 3);
+		if (mode == 1)
+			idr |= g->ODR.v & (1u << pin);
+		else
+			idr |= pin_in[port] & (1u << pin);
+	}
+	return idr;
+}
+
+
+/*----------------------------------------------------------------------------
+ *  General purpose timers: up counting, PSC and ARR, update flag and
+ *  interrupt. The counter is derived from Sim_Cycles while CEN is set;
+ *  overflows are scheduled events. PSC takes effect at the next update,
+ *  as on the chip; ARR is not preloaded.
+ *---------------------------------------------------------------------------*/
+typedef struct
+{
+	TIM_TypeDef *tim;
+	IRQn_Type irq;
+	sim_time_t start;				/* Sim_Cycles at CNT = 0 */
+	uint32_t psc;						/* prescaler in use */
+	uint32_t ev;						/* pending overflow event, 0 none */
+} sim_tim_t;
+
+static sim_tim_t sim_tims[4] =
+{
+	{ &Sim_TIM3,  TIM3_IRQn,  0, 0, 0 },
+	{ &Sim_TIM14, TIM14_IRQn, 0, 0, 0 },
+	{ &Sim_TIM16, TIM16_IRQn, 0, 0, 0 },
+	{ &Sim_TIM17, TIM17_IRQn, 0, 0, 0 },
+};
+
+
+static sim_tim_t *Sim_Tim(const SimReg *r)
+{
+	uint8_t i;
+
+	for (i = 0; i < 4; i++)
+		if (Sim_In(r, sim_tims[i].tim)) return &sim_tims[i];
+	return 0;
+}
+
+
+static sim_time_t Sim_TimPeriod(const sim_tim_t *t)
+{
+	return (sim_time_t)((t->tim->ARR.v & 0xFFFF) + 1) * (t->psc + 1);
+}
+
+
+static uint32_t Sim_TimCnt(const sim_tim_t *t)
+{
+	if ((t->tim->CR1.v & TIM_CR1_CEN) == 0) return t->tim->CNT.v;
+	return (uint32_t)((Sim_Cycles - t->start) / (t->psc + 1)) % ((t->tim->ARR.v & 0xFFFF) + 1);
+}
+
+
+static void Sim_TimArm(sim_tim_t *t);
+
+static void Sim_TimUpdate(sim_tim_t *t, uint8_t flag)
+{
+	t->start = Sim_Cycles;
+	t->psc = t->tim->PSC.v & 0xFFFF;
+	if (flag)
+	{
+		t->tim->SR.v |= TIM_SR_UIF;
+		if (t->tim->DIER.v & TIM_DIER_UIE) NVIC_SetPendingIRQ(t->irq);
+	}
+	Sim_TimArm(t);
+}
+
+
+static void Sim_TimOverflow(void *ctx)
+{
+	sim_tim_t *t = (sim_tim_t *)ctx;
+
+	t->ev = 0;
+	Sim_TimUpdate(t, 1);
+}
+
+
+static void Sim_TimArm(sim_tim_t *t)
+{
+	sim_time_t period, n;
+
+	if (t->ev) Sim_Cancel(t->ev);
+	t->ev = 0;
+	if ((t->tim->CR1.v & TIM_CR1_CEN) == 0) return;
+	period = Sim_TimPeriod(t);
+	n = (Sim_Cycles - t->start) / period + 1;
+	t->ev = Sim_Schedule(t->start + n * period, Sim_TimOverflow, t);
+}
+
+
+/**
+  * Timer register write. Returns 1 if handled.
+  */
+static uint8_t Sim_TimWrite(SimReg *r, uint32_t v)
+{
+	sim_tim_t *t = Sim_Tim(r);
+	TIM_TypeDef *tim;
+	uint32_t cnt;
+
+	if (t == 0) return 0;
+	tim = t->tim;
+	cnt = Sim_TimCnt(t);
+	if (r == &tim->SR)
+	{
+		r->v &= v;                           // rc_w0
+		return 1;
+	}
+	if (r == &tim->EGR)
+	{
+		if (v & TIM_EGR_UG) Sim_TimUpdate(t, (tim->CR1.v & TIM_CR1_URS) == 0);
+		return 1;
+	}
+	r->v = v;
+	if ((r == &tim->CR1) || (r == &tim->CNT) || (r == &tim->ARR))
+	{
+		if (r != &tim->CNT) tim->CNT.v = cnt;
+		t->start = Sim_Cycles - (sim_time_t)(tim->CNT.v & 0xFFFF) * (t->psc + 1);
+		Sim_TimArm(t);
+	}
+	return 1;
+}
+
+
+uint32_t Sim_RegRead(const SimReg *r)
+{
+	SimReg *w = (SimReg *)r;
+	size_t i;
+	uint8_t port;
+
+	Sim_Advance(SIM_REG_CYCLES);
+	stats.reg_reads++;
+
+	if (!in_hook)
+	{
+		for (i = 0; i < read_hooks.size(); i++)
+		{
+			if (read_hooks[i].reg == r)
+			{
+				in_hook = 1;
+				read_hooks[i].cb(read_hooks[i].ctx, w);
+				in_hook = 0;
+			}
+		}
+	}
+
+	if (Sim_In(r, Sim_GPIO, 6))
+	{
+		port = (uint8_t)(((const char *)r - (const char *)Sim_GPIO) / sizeof(GPIO_TypeDef));
+		if (r == &Sim_GPIO[port].IDR) return Sim_GpioIDR(port);
+		if ((r == &Sim_GPIO[port].BSRR) || (r == &Sim_GPIO[port].BRR)) return 0;
+	}
+	if ((r == &Sim_TIM3.CNT) || (r == &Sim_TIM14.CNT) || (r == &Sim_TIM16.CNT) || (r == &Sim_TIM17.CNT))
+		return Sim_TimCnt(Sim_Tim(r));
+	return r->v;
+}
+
+
+void Sim_RegWrite(SimReg *r, uint32_t v)
+{
+	uint8_t port;
+	uint32_t old;
+
+	Sim_Advance(SIM_REG_CYCLES);
+	stats.reg_writes++;
+
+	if (Sim_In(r, Sim_GPIO, 6))
+	{
+		port = (uint8_t)(((const char *)r - (const char *)Sim_GPIO) / sizeof(GPIO_TypeDef));
+		old = Sim_GPIO[port].ODR.v;
+		if (r == &Sim_GPIO[port].BSRR)
+		{
+			Sim_GPIO[port].ODR.v = (old & ~(v >> 16)) | (v & 0xFFFF);
+		}
+		else if (r == &Sim_GPIO[port].BRR)
+		{
+			Sim_GPIO[port].ODR.v = old & ~(v & 0xFFFF);
+		}
+		else if (r == &Sim_GPIO[port].ODR)
+		{
+			Sim_GPIO[port].ODR.v = v & 0xFFFF;
+		}
+		else if (r != &Sim_GPIO[port].IDR)
+		{
+			r->v = v;
+			return;
+		}
+		Sim_GpioOut(port, old, Sim_GPIO[port].ODR.v);
+		return;
+	}
+
+	if (SIM_REG_IS(r, Sim_EXTI, PR))
+	{
+		r->v &= ~v;                          // rc_w1
+		return;
+	}
+
+	if (Sim_TimWrite(r, v)) return;
+
+	r->v = v;
+
+	/* clocks are ready as soon as they are enabled */
+	if (SIM_REG_IS(r, Sim_RCC, CR))
+	{
+		r->v = (v & ~(RCC_CR_HSIRDY | RCC_CR_HSERDY | RCC_CR_PLLRDY))
+		     | ((v & RCC_CR_HSION) ? RCC_CR_HSIRDY : 0)
+		     | ((v & RCC_CR_HSEON) ? RCC_CR_HSERDY : 0)
+		     | ((v & RCC_CR_PLLON) ? RCC_CR_PLLRDY : 0);
+	}
+	else if (SIM_REG_IS(r, Sim_RCC, CFGR))
+	{
+		r->v = (v & ~RCC_CFGR_SWS) | ((v & RCC_CFGR_SW) << 2);
+	}
+	else if (SIM_REG_IS(r, Sim_RCC, CR2))
+	{
+		r->v = (v & ~RCC_CR2_HSI14RDY) | ((v & RCC_CR2_HSI14ON) ? RCC_CR2_HSI14RDY : 0);
+	}
+	/* ADC calibration completes immediately, ADEN sets ADRDY */
+	else if (SIM_REG_IS(r, Sim_ADC1, CR))
+	{
+		r->v &= ~ADC_CR_ADCAL;
+		if (v & ADC_CR_ADDIS) r->v &= ~(ADC_CR_ADEN | ADC_CR_ADDIS);
+		if (r->v & ADC_CR_ADEN) Sim_ADC1.ISR.v |= ADC_ISR_ADRDY; else Sim_ADC1.ISR.v &= ~ADC_ISR_ADRDY;
+	}
+	else if (SIM_REG_IS(r, Sim_ADC1, ISR))
+	{
+		r->v = 0;
+		Sim_ADC1.ISR.v = (Sim_ADC1.CR.v & ADC_CR_ADEN) ? ADC_ISR_ADRDY : 0;
+	}
+}
+
+
+void Sim_PinListen(uint8_t port, uint16_t mask, sim_pin_cb_t cb, void *ctx)
+{
+	sim_listener_t l;
+
+	l.cb = cb;
+	l.ctx = ctx;
+	l.port = port;
+	l.mask = mask;
+	listeners.push_back(l);
+}
+
+
+/**
+  * Input pin changed: EXTI edge detection on the line mapped to this port
+  */
+static void Sim_Exti(uint8_t port, uint8_t pin, uint8_t level)
+{
+	uint32_t line = 1u << pin;
+	uint8_t src = (uint8_t)((Sim_SYSCFG.EXTICR[pin >> 2].v >> (4 * (pin & 3))) & 0xF);
+	IRQn_Type irq;
+
+	if (src != port) return;
+	if (!((level && (Sim_EXTI.RTSR.v & line)) || (!level && (Sim_EXTI.FTSR.v & line)))) return;
+
+	Sim_EXTI.PR.v |= line;
+	if ((Sim_EXTI.IMR.v & line) == 0) return;
+	irq = (pin < 2) ? EXTI0_1_IRQn : (pin < 4) ? EXTI2_3_IRQn : EXTI4_15_IRQn;
+	NVIC_SetPendingIRQ(irq);
+}
+
+
+void Sim_SetInput(uint8_t port, uint8_t pin, uint8_t level)
+{
+	uint16_t old = pin_in[port];
+
+	if (level)
+		pin_in[port] |= (uint16_t)(1u << pin);
+	else
+		pin_in[port] &= (uint16_t)~(1u << pin);
+	if (old != pin_in[port]) Sim_Exti(port, pin, level);
+}
+
+
+uint8_t Sim_GetOutput(uint8_t port, uint8_t pin)
+{
+	return (uint8_t)((Sim_GPIO[port].ODR.v >> pin) & 1);
+}
+
+
+void Sim_ReadHook(SimReg *reg, sim_read_cb_t cb, void *ctx)
+{
+	sim_hook_t h;
+
+	h.reg = reg;
+	h.cb = cb;
+	h.ctx = ctx;
+	read_hooks.push_back(h);
+}
+
+
+const sim_stats_t *Sim_Stats(void)
+{
+	return &stats;
+}
+
+
+void Sim_ClearStats(void)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+
+void Sim_LogEnable(uint8_t on)
+{
+	log_on = on;
+	if (!on) edge_log.clear();
+}
+
+
+uint32_t Sim_LogCount(void)
+{
+	return (uint32_t)edge_log.size();
+}
+
+
+const sim_edge_t *Sim_LogGet(uint32_t i)
+{
+	return (i < edge_log.size()) ? &edge_log[i] : 0;
+}
+
+
+/**
+  * Dump logged transitions as a VCD file, one wire per used pin
+  */
+void Sim_LogWriteVCD(FILE *f)
+{
+	uint32_t used[SIM_NPORTS];
+	uint8_t port, pin;
+	size_t i;
+	sim_time_t last = (sim_time_t)-1;
+
+	memset(used, 0, sizeof(used));
+	for (i = 0; i < edge_log.size(); i++) used[edge_log[i].port] |= 1u << edge_log[i].pin;
+
+	fprintf(f, "$timescale 1ns $end\n$scope module stm32 $end\n");
+	for (port = 0; port < SIM_NPORTS; port++)
+		for (pin = 0; pin < 16; pin++)
+			if (used[port] & (1u << pin))
+				fprintf(f, "$var wire 1 %c%c P%c%d $end\n", 'a' + port, 'a' + pin, 'A' + port, pin);
+	fprintf(f, "$upscope $end\n$enddefinitions $end\n");
+
+	for (i = 0; i < edge_log.size(); i++)
+	{
+		if (edge_log[i].t != last)
+		{
+			last = edge_log[i].t;
+			fprintf(f, "#%llu\n", (unsigned long long)(last * 1000000000ULL / SIM_CORE_HZ));
+		}
+		fprintf(f, "%d%c%c\n", edge_log[i].level, 'a' + edge_log[i].port, 'a' + edge_log[i].pin);
+	}
+}
+
+
+/**
+  * Reset all registers to zero, as after power-on (reset values that
+  * matter to the firmware are zero on STM32F0 except GPIOA MODER, which
+  * is irrelevant here).
+  */
+void Sim_Reset(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < 6; i++) memset((void *)&Sim_GPIO[i], 0, sizeof(GPIO_TypeDef));
+	memset((void *)&Sim_RCC, 0, sizeof(Sim_RCC));
+	memset((void *)&Sim_EXTI, 0, sizeof(Sim_EXTI));
+	memset((void *)&Sim_SYSCFG, 0, sizeof(Sim_SYSCFG));
+	memset((void *)&Sim_ADC1, 0, sizeof(Sim_ADC1));
+	memset((void *)&Sim_ADC, 0, sizeof(Sim_ADC));
+	memset((void *)&Sim_DMA1, 0, sizeof(Sim_DMA1));
+	memset((void *)Sim_DMA1_Channel, 0, sizeof(Sim_DMA1_Channel));
+	memset((void *)&Sim_TIM3, 0, sizeof(Sim_TIM3));
+	memset((void *)&Sim_TIM14, 0, sizeof(Sim_TIM14));
+	memset((void *)&Sim_TIM16, 0, sizeof(Sim_TIM16));
+	memset((void *)&Sim_TIM17, 0, sizeof(Sim_TIM17));
+	for (i = 0; i < 4; i++)
+	{
+		sim_tims[i].start = 0;
+		sim_tims[i].psc = 0;
+		sim_tims[i].ev = 0;
+	}
+	memset((void *)&Sim_SysTick, 0, sizeof(Sim_SysTick));
+	memset((void *)&Sim_SCB, 0, sizeof(Sim_SCB));
+	memset((void *)&Sim_PWR, 0, sizeof(Sim_PWR));
+	memset((void *)&Sim_FLASH, 0, sizeof(Sim_FLASH));
+	memset(pin_in, 0, sizeof(pin_in));
+	listeners.clear();
+	read_hooks.clear();
+	edge_log.clear();
+	events.clear();
+	next_event = SIM_NEVER;
+	nvic_enabled = 0;
+	nvic_pending = 0;
+	primask = 0;
+	Sim_ClearStats();
+	Sim_Cycles = 0;
+	SystemCoreClock = SIM_CORE_HZ;
+}
+
+
+/*----------------------------------------------------------------------------
+ *      NVIC and core intrinsics
+ *---------------------------------------------------------------------------*/
+/**
+  * Vector table: handlers the firmware may define. Unused ones stay null.
+  */
+void EXTI0_1_IRQHandler(void) __attribute__((weak));
+void EXTI2_3_IRQHandler(void) __attribute__((weak));
+void EXTI4_15_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel1_IRQHandler(void) __attribute__((weak));
+void ADC1_IRQHandler(void) __attribute__((weak));
+void TIM3_IRQHandler(void) __attribute__((weak));
+void TIM14_IRQHandler(void) __attribute__((weak));
+void TIM16_IRQHandler(void) __attribute__((weak));
+void TIM17_IRQHandler(void) __attribute__((weak));
+
+static void (*Sim_Vector(uint8_t irq))(void)
+{
+	switch (irq)
+	{
+		case EXTI0_1_IRQn:       return EXTI0_1_IRQHandler;
+		case EXTI2_3_IRQn:       return EXTI2_3_IRQHandler;
+		case EXTI4_15_IRQn:      return EXTI4_15_IRQHandler;
+		case DMA1_Channel1_IRQn: return DMA1_Channel1_IRQHandler;
+		case ADC1_IRQn:          return ADC1_IRQHandler;
+		case TIM3_IRQn:          return TIM3_IRQHandler;
+		case TIM14_IRQn:         return TIM14_IRQHandler;
+		case TIM16_IRQn:         return TIM16_IRQHandler;
+		case TIM17_IRQn:         return TIM17_IRQHandler;
+	}
+	return 0;
+}
+
+
+void Sim_IsrEnter(void)
+{
+	if (isr_depth++ == 0) isr_start = Sim_Cycles;
+}
+
+
+void Sim_IsrExit(void)
+{
+	if (--isr_depth == 0) isr_cycles += Sim_Cycles - isr_start;
+}
+
+
+uint8_t Sim_InIsr(void)
+{
+	return isr_depth;
+}
+
+
+sim_time_t Sim_IsrCycles(void)
+{
+	return isr_cycles;
+}
+
+
+/**
+  * Run pending, enabled interrupts. Handlers do not nest; the one with the
+  * lowest priority value (then lowest number) goes first, as on the NVIC.
+  */
+static void Sim_IrqService(void)
+{
+	uint32_t ready;
+	uint8_t irq, best;
+	void (*handler)(void);
+
+	if (isr_depth || primask) return;
+
+	while ((ready = nvic_pending & nvic_enabled) != 0)
+	{
+		best = 32;
+		for (irq = 0; irq < 32; irq++)
+		{
+			if ((ready & (1u << irq)) && ((best == 32) || (nvic_prio[irq] < nvic_prio[best]))) best = irq;
+		}
+		nvic_pending &= ~(1u << best);
+		handler = Sim_Vector(best);
+		if (handler == 0) continue;
+
+		Sim_IsrEnter();
+		Sim_Advance(SIM_IRQ_CYCLES);
+		stats.irqs++;
+		handler();
+		Sim_Advance(SIM_IRQ_CYCLES);
+		Sim_IsrExit();
+	}
+	if (cpu_hook && !in_event) cpu_hook();
+}
+
+
+void NVIC_EnableIRQ(IRQn_Type irq)       { if (irq >= 0) { nvic_enabled |= 1u << irq; Sim_IrqService(); } }
+void NVIC_DisableIRQ(IRQn_Type irq)      { if (irq >= 0) nvic_enabled &= ~(1u << irq); }
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) { if (irq >= 0) nvic_prio[irq] = (uint8_t)priority; }
+uint32_t NVIC_GetPriority(IRQn_Type irq) { return (irq >= 0) ? nvic_prio[irq] : 0; }
+void NVIC_SetPendingIRQ(IRQn_Type irq)   { if (irq >= 0) { nvic_pending |= 1u << irq; Sim_IrqService(); } }
+void NVIC_ClearPendingIRQ(IRQn_Type irq) { if (irq >= 0) nvic_pending &= ~(1u << irq); }
+uint32_t NVIC_GetPendingIRQ(IRQn_Type irq) { return (irq >= 0) ? ((nvic_pending >> irq) & 1) : 0; }
+
+uint8_t Sim_IrqEnabled(IRQn_Type irq)
+{
+	return (irq >= 0) && (nvic_enabled & (1u << irq)) && (primask == 0);
+}
+
+/**
+  * Called by the compiler at every basic block of the firmware, which is
+  * built with -fsanitize-coverage=trace-pc. Pure computation costs no
+  * virtual time, so this is its deterministic cost.
+  */
+extern "C" void __sanitizer_cov_trace_pc(void)
+{
+	stats.blocks++;
+}
+
+
+void __nop(void)
+{
+	Sim_Advance(SIM_NOP_CYCLES);
+	stats.nops++;
+}
+
+void __WFI(void)                  { }
+void __WFE(void)                  { }
+void __DMB(void)                  { }
+void __DSB(void)                  { }
+void __ISB(void)                  { }
+void __disable_irq(void)          { primask = 1; }
+void __enable_irq(void)           { primask = 0; Sim_IrqService(); }
+uint32_t __get_PRIMASK(void)      { return primask; }
+void __set_PRIMASK(uint32_t p)    { primask = p & 1; Sim_IrqService(); }
+uint32_t __get_PSP(void)          { return 0; }
+uint32_t __get_MSP(void)          { return 0; }
+
+void SystemInit(void)             { }
+void SystemCoreClockUpdate(void)  { SystemCoreClock = SIM_CORE_HZ; }
@@ -0,0 +1,643 @@
+/**
+  ******************************************************************************
+  * @file    bench.cpp
+  * @author  e.pavlin.si
+  * @brief   Benchmarks of the measurement hot paths, JSON output
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * Each benchmark runs a fixed input set and reports per iteration: virtual
+  * cycles at 48 MHz, firmware basic blocks run, register reads and writes,
+  * AD7715 SPI clocks, LCD nibbles, data writes and data writes that did not
+  * change the display. A checksum of the results catches changes of
+  * behavior. All of these are deterministic.
+  *
+  * Pure computation costs no virtual time on the host; for those paths the
+  * basic block count is the cost. -t adds host nanoseconds per iteration,
+  * which vary from run to run.
+  *
+  * -b compares with a baseline file written by -o: the checksums must be
+  * equal and no cost may grow by more than -r percent (default
+  * BENCH_TOL_PCT). Exit status 1 if one does.
+  *
+  * usage: bench [-t] [-o file.json] [-b baseline.json [-r percent]]
+  *
+  */
+
+#include "stm32f0xx.h"
+#include "sim.h"
+#include "hd44780_model.h"
+#include "lcd.h"
+#include "ad7715.h"
+#include "timebase.h"
+#include "measure.h"
+#include "calib.h"
+#include "tempcomp.h"
+#include "hum.h"
+#include "stats.h"
+#include "trend.h"
+#include "titration.h"
+#include "fmt.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** Firmware functions without a public prototype */
+void AD7715_InitPins(void);
+uint8_t AD7715_transferbyte(uint8_t byte_out);
+void AD7715_SetCS(int state);
+void Update_Readout(uint8_t raw);
+
+/** Pins observed */
+#define BENCH_SPI_CLK		5		/* PA5 */
+#define BENCH_SPI_CS		1		/* PF1 */
+#define BENCH_AD_DOUT		6		/* PA6 */
+
+/** Allowed growth of a cost against the baseline, percent */
+#define BENCH_TOL_PCT		2.0
+
+/** Costs compared with the baseline */
+#define BENCH_NCOST			8
+
+/** Result of one benchmark */
+typedef struct
+{
+	uint32_t iterations;
+	sim_time_t cycles;
+	uint64_t blocks;
+	uint64_t reg_reads;
+	uint64_t reg_writes;
+	uint32_t spi_bits;
+	uint32_t checksum;
+	hd44780_stats_t lcd;
+	double host_ns;
+} bench_result_t;
+
+typedef void (*bench_fn_t)(bench_result_t *r);
+
+static uint32_t spi_bits;
+static uint8_t host_time;
+static FILE *out;
+static uint8_t first = 1;
+static char *base;
+static double tol = BENCH_TOL_PCT;
+static uint32_t failed;
+
+static const char *const cost_names[BENCH_NCOST] =
+{
+	"cycles", "blocks", "reg_reads", "reg_writes", "spi_bits", "lcd_nibbles", "lcd_data", "lcd_violations"
+};
+
+
+static void Bench_Edge(void *ctx, uint8_t port, uint8_t pin, uint8_t level, sim_time_t t)
+{
+	if (level && (Sim_GetOutput(SIM_PORTF, BENCH_SPI_CS) == 0)) spi_bits++;
+}
+
+
+/**
+  * FNV-1a over the results
+  */
+static void Bench_Sum(bench_result_t *r, uint32_t v)
+{
+	uint8_t i;
+
+	if (r->checksum == 0) r->checksum = 2166136261u;
+	for (i = 0; i < 4; i++)
+	{
+		r->checksum ^= (v >> (8 * i)) & 0xFF;
+		r->checksum *= 16777619u;
+	}
+}
+
+
+static double Bench_PerIter(uint64_t v, uint32_t n)
+{
+	return (double)v / (double)n;
+}
+
+
+/**
+  * Read the whole baseline file
+  */
+static char *Bench_Load(const char *file)
+{
+	FILE *f = fopen(file, "r");
+	char *buf;
+	long n;
+
+	if (f == NULL) return NULL;
+	fseek(f, 0, SEEK_END);
+	n = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	buf = (char *)calloc(1, n + 1);
+	if (buf && (fread(buf, 1, n, f) != (size_t)n)) buf[0] = 0;
+	fclose(f);
+	return buf;
+}
+
+
+/**
+  * Value of "key" in the baseline entry of benchmark name, as text
+  */
+static const char *Bench_Base(const char *name, const char *key)
+{
+	char pat[96];
+	const char *e, *end, *v;
+
+	snprintf(pat, sizeof(pat), "\"name\": \"%s\"", name);
+	e = strstr(base, pat);
+	if (e == NULL) return NULL;
+	end = strchr(e, '}');
+	snprintf(pat, sizeof(pat), "\"%s\": ", key);
+	v = strstr(e, pat);
+	if ((v == NULL) || (end && (v > end))) return NULL;
+	return v + strlen(pat);
+}
+
+
+/**
+  * Checksum equal and costs within tol percent of the baseline
+  */
+static void Bench_Compare(const char *name, const bench_result_t *r, const double *cost)
+{
+	const char *v;
+	double b;
+	uint8_t i;
+
+	v = Bench_Base(name, "checksum");
+	if (v == NULL)
+	{
+		fprintf(stderr, "bench: %s not in the baseline\n", name);
+		failed++;
+		return;
+	}
+	if (strtoul(v + 1, NULL, 16) != r->checksum)
+	{
+		fprintf(stderr, "bench: %s checksum %08x, baseline %.8s\n", name, r->checksum, v + 1);
+		failed++;
+	}
+	for (i = 0; i < BENCH_NCOST; i++)
+	{
+		v = Bench_Base(name, cost_names[i]);
+		b = v ? strtod(v, NULL) : 0.0;
+		if (cost[i] > b * (1.0 + tol / 100.0) + 0.05)
+		{
+			fprintf(stderr, "bench: %s %s %.1f, baseline %.1f\n", name, cost_names[i], cost[i], b);
+			failed++;
+		}
+		else if (cost[i] < b * (1.0 - tol / 100.0) - 0.05)
+			fprintf(stderr, "bench: %s %s %.1f, baseline %.1f, better\n", name, cost_names[i], cost[i], b);
+	}
+}
+
+
+static void Bench_Run(const char *name, bench_fn_t fn)
+{
+	bench_result_t r;
+	const sim_stats_t *s;
+	sim_time_t t0;
+	struct timespec h0, h1;
+	hd44780_stats_t dummy;
+	double cost[BENCH_NCOST];
+
+	memset(&r, 0, sizeof(r));
+	HD44780_ModelFrame(&dummy);
+	Sim_ClearStats();
+	spi_bits = 0;
+	t0 = Sim_Cycles;
+	clock_gettime(CLOCK_MONOTONIC, &h0);
+	fn(&r);
+	clock_gettime(CLOCK_MONOTONIC, &h1);
+
+	s = Sim_Stats();
+	r.cycles = Sim_Cycles - t0;
+	r.blocks = s->blocks;
+	r.reg_reads = s->reg_reads;
+	r.reg_writes = s->reg_writes;
+	r.spi_bits = spi_bits;
+	HD44780_ModelFrame(&r.lcd);
+	r.host_ns = ((double)(h1.tv_sec - h0.tv_sec) * 1e9 + (double)(h1.tv_nsec - h0.tv_nsec)) / r.iterations;
+
+	cost[0] = Bench_PerIter(r.cycles, r.iterations);
+	cost[1] = Bench_PerIter(r.blocks, r.iterations);
+	cost[2] = Bench_PerIter(r.reg_reads, r.iterations);
+	cost[3] = Bench_PerIter(r.reg_writes, r.iterations);
+	cost[4] = Bench_PerIter(r.spi_bits, r.iterations);
+	cost[5] = Bench_PerIter(r.lcd.nibbles, r.iterations);
+	cost[6] = Bench_PerIter(r.lcd.data, r.iterations);
+	cost[7] = r.lcd.v[HD_V_PWEH] + r.lcd.v[HD_V_CYCE] + r.lcd.v[HD_V_AS] + r.lcd.v[HD_V_DSW] + r.lcd.v[HD_V_BUSY];
+
+	fprintf(out, "%s\n    {\"name\": \"%s\", \"iterations\": %u, \"checksum\": \"%08x\",\n",
+	        first ? "" : ",", name, r.iterations, r.checksum);
+	fprintf(out, "     \"cycles\": %.1f, \"blocks\": %.1f, \"reg_reads\": %.1f, \"reg_writes\": %.1f, \"spi_bits\": %.1f,\n",
+	        cost[0], cost[1], cost[2], cost[3], cost[4]);
+	fprintf(out, "     \"lcd_nibbles\": %.1f, \"lcd_data\": %.1f, \"lcd_unchanged\": %.1f, \"lcd_violations\": %.0f",
+	        cost[5], cost[6], Bench_PerIter(r.lcd.redundant, r.iterations), cost[7]);
+	if (host_time) fprintf(out, ", \"host_ns\": %.1f", r.host_ns);
+	fprintf(out, "}");
+	first = 0;
+	if (base) Bench_Compare(name, &r, cost);
+}
+
+
+/*----------------------------------------------------------------------------
+ *      M_pH over all ADC codes, per calibration shape
+ *---------------------------------------------------------------------------*/
+static void Bench_Cal(uint16_t a0, uint16_t r0, uint16_t a1, uint16_t r1, uint16_t a2, uint16_t r2)
+{
+	cal_points_t pts;
+
+	pts.AD_point[0] = a0;  pts.refpoint[0] = r0;
+	pts.AD_point[1] = a1;  pts.refpoint[1] = r1;
+	pts.AD_point[2] = a2;  pts.refpoint[2] = r2;
+	pts.t_c10 = TEMP_CAL_C10;
+	Cal_Publish(&pts);
+}
+
+static void Bench_SweepPH(bench_result_t *r)
+{
+	uint32_t adc;
+
+	for (adc = 0; adc < 65536; adc++)
+		Bench_Sum(r, M_pH(adc << AD7715_FRAC));
+	r->iterations = 65536;
+}
+
+static void Bench_PH2(bench_result_t *r)
+{
+	Cal_LoadDefault();
+	Bench_SweepPH(r);
+}
+
+static void Bench_PH3(bench_result_t *r)
+{
+	Bench_Cal(30610, 4000, 27275, 7000, 23940, 10000);
+	Bench_SweepPH(r);
+}
+
+static void Bench_PH3Bent(bench_result_t *r)
+{
+	Bench_Cal(30610, 4000, 27100, 7000, 24300, 10000);
+	Bench_SweepPH(r);
+}
+
+static void Bench_PH3Rising(bench_result_t *r)
+{
+	Bench_Cal(23940, 4000, 27275, 7000, 30610, 10000);
+	Bench_SweepPH(r);
+}
+
+
+/*----------------------------------------------------------------------------
+ *      Averaging filter of AD7715_Thread: settle, step, noise
+ *---------------------------------------------------------------------------*/
+static void Bench_Average(bench_result_t *r)
+{
+	ad7715_avg_t avg = { 0, 0, 0 };
+	uint32_t i, x = 1;
+
+	for (i = 0; i < 4096; i++)
+	{
+		uint16_t rd = (i < 2048) ? 27275 : 23940;
+		x = x * 1103515245u + 12345u;
+		rd = (uint16_t)(rd + ((x >> 16) & 0x1F) - 16);
+		Bench_Sum(r, AD7715_Average(&avg, rd));
+	}
+	r->iterations = 4096;
+}
+
+
+/*----------------------------------------------------------------------------
+ *      Hum detector: one block per case, 60 Hz and 50 Hz tones, then none
+ *---------------------------------------------------------------------------*/
+static void Bench_Hum(bench_result_t *r)
+{
+	static const double hz[3] = { 60.0, 50.0, 0.0 };
+	hum_det_t det;
+	uint8_t fs = AD7715_FS_50HZ;
+	uint32_t c, i;
+
+	for (c = 0; c < 3; c++)
+	{
+		Hum_Start(&det);
+		for (i = 0; i < HUM_N; i++)
+			Hum_Sample(&det, (uint16_t)(26608.5 + 40.0 * sin(2.0 * M_PI * hz[c] * i / HUM_FS_HZ + 0.3)));
+		fs = Hum_Decide(&det, fs);
+		Bench_Sum(r, fs);
+		Bench_Sum(r, Hum.amp_q8[HUM_50HZ]);
+		Bench_Sum(r, Hum.amp_q8[HUM_60HZ]);
+	}
+	r->iterations = 3 * HUM_N;
+}
+
+
+/*----------------------------------------------------------------------------
+ *      Windowed statistics: the same noisy step in the shortest and the
+ *      longest window, read after every conversion
+ *---------------------------------------------------------------------------*/
+static void Bench_StatsWin(bench_result_t *r, uint16_t len)
+{
+	stats_result_t st;
+	uint32_t i, x = 1;
+
+	Stats_SetWindow(len);
+	for (i = 0; i < 1024; i++)
+	{
+		uint16_t rd = (i < 512) ? 27275 : 23940;
+		x = x * 1103515245u + 12345u;
+		rd = (uint16_t)(rd + ((x >> 16) & 0x1F) - 16);
+		Stats_Sample(rd);
+		Stats_Get(&st);
+		Bench_Sum(r, st.mean_q8);
+		Bench_Sum(r, st.sd_q8);
+		Bench_Sum(r, ((uint32_t)st.max << 16) | st.min);
+	}
+	r->iterations = 1024;
+}
+
+static void Bench_Stats16(bench_result_t *r)
+{
+	Bench_StatsWin(r, STATS_WIN(0));
+}
+
+static void Bench_Stats128(bench_result_t *r)
+{
+	Bench_StatsWin(r, STATS_WIN(STATS_NWIN - 1));
+}
+
+
+/*----------------------------------------------------------------------------
+ *      Titration endpoints: one equivalence point, pH 4 to 9 over about
+ *      20 points, with up to 0.2 pH of noise on the steep part (several
+ *      local maxima of the slope) and on the conversions. One endpoint is
+ *      expected, near pH 6.5; the checksum pins it.
+ *---------------------------------------------------------------------------*/
+static void Bench_Titration(bench_result_t *r)
+{
+	const titr_status_t *ts;
+	uint32_t p, i, x = 1;
+	double ph, s;
+	uint8_t e;
+
+	Cal_LoadDefault();
+	Titration_Start();
+	Titration_Sample(0);
+	for (p = 0; p < 120; p++)
+	{
+		x = x * 1103515245u + 12345u;
+		s = 1.0 / (1.0 + exp(-((double)p - 60.0) / 4.0));
+		ph = 4.0 + 5.0 * s + (((x >> 16) & 0xFF) - 127.5) / 127.5 * 0.8 * s * (1.0 - s);
+		for (i = 0; i < TITR_DECIM; i++)
+		{
+			x = x * 1103515245u + 12345u;
+			Titration_Sample((uint16_t)(30610.0 - (ph - 4.0) * 1334.0 + ((x >> 16) & 0x3F) - 32));
+		}
+	}
+	ts = Titration_Status();
+	Bench_Sum(r, ts->n_ep);
+	for (e = 0; e < ts->n_ep; e++)
+	{
+		Bench_Sum(r, ((uint32_t)ts->ep[e].t << 16) | ts->ep[e].ph);
+		Bench_Sum(r, (uint16_t)ts->ep[e].slope);
+	}
+	if (ts->n_ep != 1) fprintf(stderr, "bench: titration found %u endpoints\n", ts->n_ep);
+	Titration_Stop();
+	r->iterations = 120 * TITR_DECIM;
+}
+
+
+/*----------------------------------------------------------------------------
+ *      Display formatting and LCD traffic
+ *---------------------------------------------------------------------------*/
+static void Bench_Screen(bench_result_t *r)
+{
+	char row[17];
+	uint8_t i;
+
+	HD44780_ModelText(0, row, 16);
+	for (i = 0; i < 16; i++) Bench_Sum(r, (uint8_t)row[i]);
+	HD44780_ModelText(1, row, 16);
+	for (i = 0; i < 16; i++) Bench_Sum(r, (uint8_t)row[i]);
+}
+
+static void Bench_Glyphs(bench_result_t *r)
+{
+	const uint8_t *cg = HD44780_ModelCGRAM();
+	uint8_t i;
+
+	for (i = 0; i < 64; i++) Bench_Sum(r, cg[i]);
+}
+
+static void Bench_TrendPoint(bench_result_t *r)
+{
+	uint32_t i, j, x = 1;
+
+	Trend_Invalidate();
+	Trend_Draw();
+	for (i = 0; i < 64; i++)
+	{
+		x = x * 1103515245u + 12345u;
+		for (j = 0; j < TREND_POINT_S; j++) Trend_Sample((uint16_t)(7000 + i / 4 + ((x >> 16) & 0x0F)));
+		Trend_Draw();
+	}
+	Bench_Glyphs(r);
+	Bench_Screen(r);
+	r->iterations = 64;
+}
+
+static void Bench_TrendFull(bench_result_t *r)
+{
+	uint8_t i;
+
+	for (i = 0; i < 16; i++)
+	{
+		Trend_Invalidate();
+		Trend_Draw();
+	}
+	Bench_Glyphs(r);
+	Bench_Screen(r);
+	r->iterations = 16;
+}
+
+static void Bench_Readout(bench_result_t *r)
+{
+	uint8_t i;
+
+	for (i = 0; i < 16; i++) Update_Readout(0);
+	Bench_Screen(r);
+	r->iterations = 16;
+}
+
+static void Bench_ReadoutRaw(bench_result_t *r)
+{
+	uint8_t i;
+
+	for (i = 0; i < 16; i++) Update_Readout(1);
+	Bench_Screen(r);
+	r->iterations = 16;
+}
+
+static void Bench_Puts16(bench_result_t *r)
+{
+	char text[] = "pH meter 1234567";
+	uint8_t i;
+
+	for (i = 0; i < 16; i++)
+	{
+		text[15] = (char)('A' + i);
+		LCD_Puts(0, 1, text);
+	}
+	Bench_Screen(r);
+	r->iterations = 16;
+}
+
+static void Bench_Puts1(bench_result_t *r)
+{
+	char text[2] = "x";
+	uint8_t i;
+
+	for (i = 0; i < 16; i++)
+	{
+		text[0] = (char)('a' + i);
+		LCD_Puts(15, 0, text);
+	}
+	Bench_Screen(r);
+	r->iterations = 16;
+}
+
+/** Readout lines as Update_Readout() and the temperature line build them,
+    without the LCD: cost of formatting one line */
+static void Bench_FmtLine(bench_result_t *r)
+{
+	char str[17], *p, *e = str + 16;
+	int32_t ph = 7000, t = 250;
+	uint16_t i;
+	uint8_t j;
+
+	for (i = 0; i < 256; i++)
+	{
+		ph = ph * 7 / 8 + (int32_t)(i * 37 % 14001) / 8;
+		t = (i & 1) ? -t + 3 : -t - 7;
+		if (i & 2)
+		{
+			p = Fmt_Str(str, e, "pH:", 0);
+			p = Fmt_Fixed(p, e, ph, 3, 0);
+		}
+		else
+		{
+			p = Fmt_Str(str, e, "T:", 0);
+			p = Fmt_Fixed(p, e, t, 1, 0);
+			p = Fmt_Char(p, e, 'C');
+			if (i & 4) p = Fmt_Char(p, e, '?');
+		}
+		Fmt_Fill(str, p, 16);
+		for (j = 0; j < 16; j++) Bench_Sum(r, (uint8_t)str[j]);
+	}
+	r->iterations = 256;
+}
+
+
+/*----------------------------------------------------------------------------
+ *      AD7715 bit traffic
+ *---------------------------------------------------------------------------*/
+static void Bench_Transfer(bench_result_t *r)
+{
+	uint16_t i;
+
+	AD7715_SetCS(0);
+	for (i = 0; i < 256; i++)
+	{
+		Sim_SetInput(SIM_PORTA, BENCH_AD_DOUT, (uint8_t)(i & 1));
+		Bench_Sum(r, AD7715_transferbyte((uint8_t)i));
+	}
+	AD7715_SetCS(1);
+	r->iterations = 256;
+}
+
+static void Bench_DataRead(bench_result_t *r)
+{
+	uint8_t i;
+
+	for (i = 0; i < 64; i++)
+	{
+		AD7715_SetCS(0);
+		AD7715_transferbyte(0x38);
+		Bench_Sum(r, AD7715_transferbyte(0xff));
+		Bench_Sum(r, AD7715_transferbyte(0xff));
+		AD7715_SetCS(1);
+	}
+	r->iterations = 64;
+}
+
+
+int main(int argc, char **argv)
+{
+	int i;
+
+	out = stdout;
+	for (i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-t")) host_time = 1;
+		else if (!strcmp(argv[i], "-o") && (i + 1 < argc))
+		{
+			out = fopen(argv[++i], "w");
+			if (out == NULL) { perror(argv[i]); return 1; }
+		}
+		else if (!strcmp(argv[i], "-b") && (i + 1 < argc))
+		{
+			base = Bench_Load(argv[++i]);
+			if (base == NULL) { perror(argv[i]); return 1; }
+		}
+		else if (!strcmp(argv[i], "-r") && (i + 1 < argc)) tol = atof(argv[++i]);
+		else { fprintf(stderr, "usage: bench [-t] [-o file.json] [-b baseline.json [-r percent]]\n"); return 1; }
+	}
+
+	Sim_Reset();
+	HD44780_ModelInit(0);
+	Tb_Init();
+	Sim_PinListen(SIM_PORTA, 1u << BENCH_SPI_CLK, Bench_Edge, NULL);
+	Sim_SetInput(SIM_PORTA, BENCH_AD_DOUT, 1);
+	Temp_Init();
+	Cal_Init();
+	LCD_Init(16, 2);
+	AD7715_InitPins();
+
+	fprintf(out, "{\n  \"suite\": \"phmeter-host\",\n  \"clock_hz\": %lu,\n  \"benchmarks\": [", (unsigned long)SIM_CORE_HZ);
+	Bench_Run("M_pH cal2 default", Bench_PH2);
+	Bench_Run("M_pH cal3 linear", Bench_PH3);
+	Bench_Run("M_pH cal3 bent", Bench_PH3Bent);
+	Bench_Run("M_pH cal3 rising", Bench_PH3Rising);
+	Bench_Run("AD7715_Average", Bench_Average);
+	Bench_Run("Hum_Sample", Bench_Hum);
+	Bench_Run("Stats window 16", Bench_Stats16);
+	Bench_Run("Stats window 128", Bench_Stats128);
+	Bench_Run("Update_Readout", Bench_Readout);
+	Bench_Run("Update_Readout raw", Bench_ReadoutRaw);
+	Bench_Run("Trend_Draw new point", Bench_TrendPoint);
+	Bench_Run("Trend_Draw full", Bench_TrendFull);
+	Bench_Run("LCD_Puts 16 chars", Bench_Puts16);
+	Bench_Run("LCD_Puts 1 char", Bench_Puts1);
+	Bench_Run("Fmt readout line", Bench_FmtLine);
+	Bench_Run("AD7715_transferbyte", Bench_Transfer);
+	Bench_Run("AD7715 data read", Bench_DataRead);
+	Bench_Run("Titration endpoints", Bench_Titration);
+	fprintf(out, "\n  ]\n}\n");
+
+	if (out != stdout) fclose(out);
+	if (base)
+	{
+		if (failed) fprintf(stderr, "bench: %u regressions beyond %.1f%%\n", failed, tol);
+		else fprintf(stderr, "bench: within %.1f%% of the baseline\n", tol);
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+/**
+  ******************************************************************************
+  * @file    busprobe.cpp
+  * @author  e.pavlin.si
+  * @brief   Bus timing and traffic per driver operation, on the host
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * Calls driver functions directly and reports for each one:
+  *
+  *   us       virtual time at 48 MHz
+  *   rd/wr    peripheral register reads and writes
+  *   spi      AD7715 clock pulses (PA5 rising while CS PF1 is low)
+  *   nib      LCD nibbles (E PA4 falling edges)
+  *
+  * usage: busprobe [-v file.vcd]
+  *
+  */
+
+#include "stm32f0xx.h"
+#include "cmsis_os.h"
+#include "sim.h"
+#include "lcd.h"
+#include "ad7715.h"
+#include "timebase.h"
+#include "encoder.h"
+#include "measure.h"
+#include "calib.h"
+#include "tempcomp.h"
+#include <stdio.h>
+#include <string.h>
+
+/** Firmware functions without a public prototype */
+void AD7715_InitPins(void);
+void AD7715_Reset(void);
+uint8_t AD7715_transferbyte(uint8_t byte_out);
+void AD7715_SetCS(int state);
+void Update_Readout(uint8_t raw);
+void cls(void);
+void Encoder_Init(void);
+
+/** Pins observed */
+#define PROBE_SPI_CLK		5		/* PA5 */
+#define PROBE_SPI_CS		1		/* PF1 */
+#define PROBE_LCD_E			4		/* PA4 */
+
+static uint32_t spi_bits, lcd_nibbles;
+
+
+static void Probe_Edge(void *ctx, uint8_t port, uint8_t pin, uint8_t level, sim_time_t t)
+{
+	if ((port == SIM_PORTA) && (pin == PROBE_SPI_CLK) && level &&
+	    (Sim_GetOutput(SIM_PORTF, PROBE_SPI_CS) == 0)) spi_bits++;
+	if ((port == SIM_PORTA) && (pin == PROBE_LCD_E) && !level) lcd_nibbles++;
+}
+
+
+static void Probe_Report(const char *name, sim_time_t t0)
+{
+	const sim_stats_t *s = Sim_Stats();
+
+	printf("%-24s %10.1f %8llu %8llu %6u %6u\n", name, Sim_Us(Sim_Cycles - t0),
+	       (unsigned long long)s->reg_reads, (unsigned long long)s->reg_writes,
+	       spi_bits, lcd_nibbles);
+}
+
+#define PROBE(name, call) \
+	do { sim_time_t t0; \
+	     Sim_ClearStats(); spi_bits = 0; lcd_nibbles = 0; t0 = Sim_Cycles; \
+	     call; \
+	     Probe_Report(name, t0); } while (0)
+
+
+int main(int argc, char **argv)
+{
+	const char *vcd = NULL;
+	char text[] = "pH meter 1234567";
+
+	if ((argc == 3) && !strcmp(argv[1], "-v")) vcd = argv[2];
+
+	Sim_Reset();
+	Sim_LogEnable(vcd != NULL);
+	Tb_Init();
+	Sim_PinListen(SIM_PORTA, (1u << PROBE_SPI_CLK) | (1u << PROBE_LCD_E), Probe_Edge, NULL);
+	Sim_SetInput(SIM_PORTA, 6, 1);			/* AD7715 DOUT idles high */
+
+	Temp_Init();
+	Cal_Init();
+
+	printf("%-24s %10s %8s %8s %6s %6s\n", "operation", "us", "rd", "wr", "spi", "nib");
+	PROBE("LCD_Init", LCD_Init(16, 2));
+	PROBE("LCD_Clear", LCD_Clear());
+	PROBE("LCD_Puts 16 chars", LCD_Puts(0, 0, text));
+	PROBE("LCD_Puts 1 char", LCD_Puts(15, 1, (char *)"x"));
+	PROBE("AD7715_InitPins", AD7715_InitPins());
+	PROBE("AD7715_Reset", AD7715_Reset());
+	PROBE("AD7715_transferbyte", { AD7715_SetCS(0); AD7715_transferbyte(0x10); AD7715_SetCS(1); });
+	PROBE("AD7715 read 16 bit", { AD7715_SetCS(0); AD7715_transferbyte(0x38);
+	                              AD7715_transferbyte(0); AD7715_transferbyte(0); AD7715_SetCS(1); });
+	PROBE("Update_Readout", Update_Readout(0));
+	PROBE("Update_Readout raw", Update_Readout(1));
+	PROBE("Encoder_Init", Encoder_Init());
+
+	if (vcd)
+	{
+		FILE *f = fopen(vcd, "w");
+		if (f == NULL) { perror(vcd); return 1; }
+		Sim_LogWriteVCD(f);
+		fclose(f);
+	}
+	return 0;
+}
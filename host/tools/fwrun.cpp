@@ -0,0 +1,358 @@
+/**
+  ******************************************************************************
+  * @file    fwrun.cpp
+  * @author  e.pavlin.si
+  * @brief   Run the complete firmware on the host kernel
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * main.c is built with main renamed to Firmware_Main and started as a
+  * thread, so AD7715_Thread, Measure_Thread and the encoder interrupts run
+  * together as on the meter. The AD7715 model reads an electrode in a
+  * solution whose pH can step during the run. The host main thread has
+  * realtime priority; it schedules stimuli, runs for the requested virtual
+  * time and prints per-thread CPU time, converter counters, the LCD
+  * content, LCD timing violations and the profiled regions (prof.h).
+  *
+  * usage: fwrun [-t seconds] [-p ph] [-n uV] [-m uV:hz] [-s ms:ph] [-u ms] [-d ms] [-k ms] [-e ms:period:n]
+  *              [-T file] [-L file] ...
+  *   -t  virtual run time, default 10 s
+  *   -p  initial pH, default 7
+  *   -n  electrode noise, uV rms, default 20
+  *   -m  mains hum at the input, uV peak and Hz
+  *   -s  solution pH changes to ph at ms
+  *   -u  encoder step up at ms
+  *   -d  encoder step down at ms
+  *   -k  key press at ms (released 100 ms later)
+  *   -e  n encoder steps from ms on, every period ms, alternately up and down
+  *   -T  write the event trace ring to file at the end, for tracedump
+  *   -L  write encoder to display latency percentiles (trace.h) to file, JSON
+  *
+  * The latencies are also collected one by one, from TraceLat.last every
+  * RUN_LAT_POLL_US, so the percentiles printed and written are exact; the
+  * firmware histogram is printed next to them.
+  *
+  */
+
+#include "stm32f0xx.h"
+#include "cmsis_os.h"
+#include "sim.h"
+#include "os_sim.h"
+#include "ad7715_model.h"
+#include "electrode.h"
+#include "hd44780_model.h"
+#include "encoder.h"
+#include "ad7715.h"
+#include "measure.h"
+#include "prof.h"
+#include "trace.h"
+#include "stkmon.h"
+#include "cpuload.h"
+#include "hum.h"
+#include "rtmon.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+int Firmware_Main(void);
+
+/** Latency percentiles reported */
+#define RUN_NPCT				4
+
+/** Latencies kept, and how often TraceLat is read; far below one encoder step */
+#define RUN_LAT_MAX			4096
+#define RUN_LAT_POLL_US	1000
+
+/** AD7715 reference, V */
+#define RUN_VREF				2.5
+
+/** uV per ADC code Q16.8: bipolar, gain 2 */
+#define RUN_UV_Q8				(RUN_VREF / 2.0 / 32768.0 * 1e6 / 256.0)
+
+/** Stimulus kinds */
+#define RUN_A_LOW				0
+#define RUN_A_HIGH			1
+#define RUN_B_LOW				2
+#define RUN_B_HIGH			3
+#define RUN_K_LOW				4
+#define RUN_K_HIGH			5
+
+
+static electrode_t electrode;
+
+static const uint8_t run_pct[RUN_NPCT] = { 50, 90, 99, 100 };
+
+static uint32_t run_lat[RUN_LAT_MAX];
+static uint32_t run_nlat, run_lat_seen, run_lat_lost;
+
+
+static void Firmware_Thread(void const *argument)
+{
+	Firmware_Main();
+}
+
+osThreadDef(Firmware_Thread, osPriorityNormal, 1, 0);
+
+
+static void Run_Pin(void *ctx)
+{
+	switch ((uintptr_t)ctx)
+	{
+		case RUN_A_LOW:  Sim_SetInput(SIM_PORTA, ENCODER_APINn, 0); break;
+		case RUN_A_HIGH: Sim_SetInput(SIM_PORTA, ENCODER_APINn, 1); break;
+		case RUN_B_LOW:  Sim_SetInput(SIM_PORTA, ENCODER_BPINn, 0); break;
+		case RUN_B_HIGH: Sim_SetInput(SIM_PORTA, ENCODER_BPINn, 1); break;
+		case RUN_K_LOW:  Sim_SetInput(SIM_PORTF, ENCODER_KPINn, 0); break;
+		case RUN_K_HIGH: Sim_SetInput(SIM_PORTF, ENCODER_KPINn, 1); break;
+	}
+}
+
+
+static void Run_At(double ms, uintptr_t what)
+{
+	Sim_Schedule(SIM_US(ms * 1000.0), Run_Pin, (void *)what);
+}
+
+
+/**
+  * One encoder detent: A falls while B shows the direction, both return
+  * high 2 ms later
+  */
+static void Run_Step(double ms, uint8_t up)
+{
+	Run_At(ms, up ? RUN_B_LOW : RUN_B_HIGH);
+	Run_At(ms + 0.5, RUN_A_LOW);
+	Run_At(ms + 2.0, RUN_B_HIGH);
+	Run_At(ms + 2.5, RUN_A_HIGH);
+}
+
+
+/**
+  * Take the latency measured since the last poll. More than one means
+  * the poll is too slow; those are counted as lost.
+  */
+static void Run_LatPoll(void *ctx)
+{
+	uint32_t n = TraceLat.count - run_lat_seen;
+
+	if (n)
+	{
+		if (run_nlat < RUN_LAT_MAX) run_lat[run_nlat++] = TraceLat.last;
+		else run_lat_lost++;
+		run_lat_lost += n - 1;
+		run_lat_seen = TraceLat.count;
+	}
+	Sim_Schedule(Sim_Cycles + SIM_US(RUN_LAT_POLL_US), Run_LatPoll, NULL);
+}
+
+
+static int Run_LatCmp(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+
+/**
+  * Exact latency that pct percent of the collected ones do not exceed,
+  * nearest rank; run_lat sorted
+  */
+static double Run_LatPct(uint8_t pct)
+{
+	uint32_t k;
+
+	if (run_nlat == 0) return 0.0;
+	k = (run_nlat * pct + 99) / 100;
+	return (double)run_lat[(k ? k : 1) - 1];
+}
+
+
+static double Run_LatMean(void)
+{
+	uint64_t sum = 0;
+	uint32_t i;
+
+	for (i = 0; i < run_nlat; i++) sum += run_lat[i];
+	return run_nlat ? (double)sum / run_nlat : 0.0;
+}
+
+
+/**
+  * Custom characters on the second line, dot by dot, if there are any
+  */
+static void Run_Glyphs(void)
+{
+	const uint8_t *cg = HD44780_ModelCGRAM();
+	char row[17], dots[16 * 6 + 1];
+	int i, r, b, n;
+
+	HD44780_ModelText(1, row, 16);
+	for (i = 0; (i < 16) && ((uint8_t)row[i] >= 0x10); i++);
+	if (i == 16) return;
+	for (r = 0; r < 8; r++)
+	{
+		for (i = 0, n = 0; i < 16; i++)
+		{
+			if ((uint8_t)row[i] >= 0x10) continue;
+			for (b = 0; b < 5; b++) dots[n++] = (cg[8 * (row[i] & 7) + r] & (0x10 >> b)) ? '#' : '.';
+			dots[n++] = ' ';
+		}
+		dots[n] = 0;
+		printf("CGRAM %s\n", dots);
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	double seconds = 10.0;
+	double ms, ph, period;
+	const char *trace_file = NULL, *lat_file = NULL;
+	const ad7715_model_stats_t *as;
+	const hd44780_stats_t *ls;
+	const os_sim_thread_t *th;
+	stats_result_t st;
+	char row[17], line[PROF_LINE_LEN];
+	clock_t c0;
+	int i, j, n;
+
+	Sim_Reset();
+	Electrode_Init(&electrode, 7.0);
+	AD7715_ModelInit(Electrode_Ain, &electrode, RUN_VREF);
+	HD44780_ModelInit(0);
+	Sim_SetInput(SIM_PORTA, ENCODER_APINn, 1);
+	Sim_SetInput(SIM_PORTA, ENCODER_BPINn, 1);
+	Sim_SetInput(SIM_PORTF, ENCODER_KPINn, 1);
+
+	for (i = 1; i + 1 < argc; i += 2)
+	{
+		double v = atof(argv[i + 1]);
+		if (!strcmp(argv[i], "-t")) seconds = v;
+		else if (!strcmp(argv[i], "-p")) Electrode_Init(&electrode, v);
+		else if (!strcmp(argv[i], "-n")) electrode.noise = v * 1e-6;
+		else if (!strcmp(argv[i], "-m") && (sscanf(argv[i + 1], "%lf:%lf", &ms, &ph) == 2)) AD7715_ModelHum(ms * 1e-6, ph);
+		else if (!strcmp(argv[i], "-s") && (sscanf(argv[i + 1], "%lf:%lf", &ms, &ph) == 2)) Electrode_Step(&electrode, ms / 1000.0, ph);
+		else if (!strcmp(argv[i], "-u")) Run_Step(v, 1);
+		else if (!strcmp(argv[i], "-d")) Run_Step(v, 0);
+		else if (!strcmp(argv[i], "-e") && (sscanf(argv[i + 1], "%lf:%lf:%d", &ms, &period, &n) == 3))
+			for (j = 0; j < n; j++) Run_Step(ms + j * period, (uint8_t)(~j & 1));
+		else if (!strcmp(argv[i], "-T")) trace_file = argv[i + 1];
+		else if (!strcmp(argv[i], "-L")) lat_file = argv[i + 1];
+		else if (!strcmp(argv[i], "-k")) { Run_At(v, RUN_K_LOW); Run_At(v + 100.0, RUN_K_HIGH); }
+		else { fprintf(stderr, "unknown option %s\n", argv[i]); return 1; }
+	}
+
+	Sim_Schedule(SIM_US(RUN_LAT_POLL_US), Run_LatPoll, NULL);
+	c0 = clock();
+	osKernelInitialize();
+	osThreadSetPriority(osThreadGetId(), osPriorityRealtime);
+	osThreadCreate(osThread(Firmware_Thread), NULL);
+	osKernelStart();
+
+	OS_SimRunFor(SIM_US(seconds * 1e6));
+
+	OS_SimReport(stdout);
+	as = AD7715_ModelStats();
+	printf("AD7715: %u conversions at %.0f Hz, %u read, %u missed, %u polls, %u filter resets, "
+	       "self-cal %u done %u aborted, %u errors\n",
+	       as->conversions, AD7715_ModelRate(), as->data_reads, as->missed, as->comm_reads,
+	       as->filter_resets, as->cal_done, as->cal_aborted, as->errors);
+	printf("electrode pH %.3f, readout %.2f, noise %.2f codes, M_pH %.3f, resolution %.3f pH\n",
+	       Electrode_pH(&electrode, Sim_Cycles), AD7715_ReadoutQ8() / 256.0, AD7715_NoiseQ8() / 256.0,
+	       M_pH(AD7715_ReadoutQ8()) / 1000.0, M_Resolution(AD7715_ReadoutQ8()) / 1000.0);
+	Stats_Get(&st);
+	printf("stats: %u of %u conversions, mean %.2f, sd %.2f, min %u, max %u codes\n",
+	       st.n, st.len, st.mean_q8 / 256.0, st.sd_q8 / 256.0, st.min, st.max);
+	printf("hum: 50 Hz %.0f uV, 60 Hz %.0f uV, notch %s Hz, rejected %.0f uV, %u checks\n",
+	       Hum.amp_q8[HUM_50HZ] * RUN_UV_Q8, Hum.amp_q8[HUM_60HZ] * RUN_UV_Q8,
+	       (AD7715_MainsRate() == AD7715_FS_60HZ) ? "60" : "50", Hum.rejected_q8 * RUN_UV_Q8, Hum.runs);
+	for (i = 0; i < OS_SimThreadCount(); i++)
+	{
+		th = OS_SimThread((uint8_t)i);
+		if (strcmp(th->name, "AD7715_Thread") == 0)
+			printf("acquisition: blocks of up to %u, %u wakeups, %.1f conversions per wakeup, %u overruns\n",
+			       AD7715_BLOCK_N, th->wakeups, as->data_reads / (double)(th->wakeups ? th->wakeups : 1),
+			       AD7715_Overruns());
+	}
+	printf("boot: first AD7715 result %.1f ms, settled readout %.1f ms, pH shown %.1f ms\n",
+	       Sim_Us(as->first_ready) / 1000.0, AD7715_SettledTime() / 1000.0, M_BootTime() / 1000.0);
+	ls = HD44780_ModelStats();
+	printf("LCD: %u commands, %u data (%u unchanged), bus %.1f ms, controller busy %.1f ms\n",
+	       ls->cmds, ls->data, ls->redundant, Sim_Us(ls->bus) / 1000.0, Sim_Us(ls->exec) / 1000.0);
+	for (i = 0; i < HD_V_COUNT; i++)
+		if (ls->v[i])
+			printf("LCD: %u x %s, first at %.3f ms\n", ls->v[i], HD44780_ModelViolation((uint8_t)i),
+			       Sim_Us(ls->v_first[i]) / 1000.0);
+	for (i = 0; i < 2; i++)
+	{
+		int j;
+		HD44780_ModelText((uint8_t)i, row, 16);
+		for (j = 0; j < 16; j++)
+			if ((uint8_t)row[j] < 0x20) row[j] = (char)('0' + row[j]);
+		printf("LCD |%s|\n", row);
+	}
+	Run_Glyphs();
+	printf("%-14s%11s%11s%11s%11s\n", "region", "count", "min", "avg", "max");
+	for (i = 0; i < PROF_NREGIONS; i++)
+	{
+		Prof_Line(line, (uint8_t)i);
+		printf("%s\n", line);
+	}
+	printf("%-16s%7s\n", "load", "last s");
+	for (i = 0; i <= LOAD_NTHREADS; i++)
+	{
+		Load_Line(line, (uint8_t)i);
+		printf("%s\n", line);
+	}
+	printf("%-16s%7s%7s%7s\n", "stack", "size", "used", "free");
+	for (i = 0; i < STK_NTHREADS; i++)
+	{
+		Stk_Line(line, (uint8_t)i);
+		printf("%s\n", line);
+	}
+	printf("%-12s%8s%8s%8s%8s%7s%8s\n", "job ms", "period", "dline", "resp", "exec", "misses", "runs");
+	for (i = 0; i < RT_NJOBS; i++)
+	{
+		Rt_Line(line, (uint8_t)i);
+		printf("%s\n", line);
+	}
+	qsort(run_lat, run_nlat, sizeof(run_lat[0]), Run_LatCmp);
+	printf("encoder to display: %u, avg %.0f us", run_nlat, Run_LatMean());
+	for (i = 0; i < RUN_NPCT; i++) printf(", p%u %.0f us", run_pct[i], Run_LatPct(run_pct[i]));
+	if (run_lat_lost) printf(", %u lost", run_lat_lost);
+	printf("\n");
+	printf("latency histogram: %u, avg %.0f us", TraceLat.count,
+	       TraceLat.count ? (double)TraceLat.sum / TraceLat.count : 0.0);
+	for (i = 0; i < RUN_NPCT; i++) printf(", p%u %.0f us", run_pct[i], (double)Trace_LatPct(run_pct[i]));
+	printf("\n");
+	printf("interrupts %llu, encoder %d, host %.3f s\n", (unsigned long long)Sim_Stats()->irqs,
+	       Encoder_State(), (double)(clock() - c0) / CLOCKS_PER_SEC);
+	if (trace_file)
+	{
+		FILE *f = fopen(trace_file, "wb");
+		if (f == NULL) { perror(trace_file); return 1; }
+		fwrite(&Trace, sizeof(Trace), 1, f);
+		fclose(f);
+	}
+	if (lat_file)
+	{
+		FILE *f = fopen(lat_file, "w");
+		if (f == NULL) { perror(lat_file); return 1; }
+		fprintf(f, "{\n  \"count\": %u,\n  \"lost\": %u,\n  \"mean_us\": %.1f,\n  \"min_us\": %.1f",
+		        run_nlat, run_lat_lost, Run_LatMean(), run_nlat ? (double)run_lat[0] : 0.0);
+		for (i = 0; i < RUN_NPCT; i++) fprintf(f, ",\n  \"p%u_us\": %.1f", run_pct[i], Run_LatPct(run_pct[i]));
+		fprintf(f, "\n}\n");
+		fclose(f);
+	}
+	return 0;
+}
@@ -0,0 +1,191 @@
+/**
+  ******************************************************************************
+  * @file    rammap.cpp
+  * @author  e.pavlin.si
+  * @brief   Static RAM use by module, from the armlink map file
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * Reads Listings/ph1.map as written by uVision (Linker, Listing: Memory
+  * Map, Symbols, Size Info). From "Image component sizes" it sums RW and
+  * ZI data per object and per library. From the symbol table it lists
+  * the data symbols in RAM, largest first, so stacks, buffers and RTX
+  * pools can be told apart. Thread stacks of RTX come from mp_stk
+  * (default size) and os_stack_mem (osThreadDef with a size, main, timer
+  * thread) in RTX_Conf_CM.o; the MSP stack and heap are in the startup
+  * object.
+  *
+  * With -c the same table gives flash use instead: Code and RO data per
+  * object, to see what a change costs in code size.
+  *
+  * usage: rammap [-c] [-n symbols] [-r ram_bytes] file.map
+  *
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+/** STM32F070C6 */
+#define RAM_BASE		0x20000000UL
+#define RAM_SIZE		6144
+
+/** Parser state in "Image component sizes" */
+#define MAP_NONE		0
+#define MAP_TAKE		1
+#define MAP_SKIP		2
+
+struct ram_obj
+{
+	std::string name;
+	unsigned long code, ro, rw, zi;
+};
+
+struct ram_sym
+{
+	std::string name, obj;
+	unsigned long addr, size;
+};
+
+
+static bool Map_ByRam(const ram_obj &a, const ram_obj &b)
+{
+	return (a.rw + a.zi) > (b.rw + b.zi);
+}
+
+
+static bool Map_ByFlash(const ram_obj &a, const ram_obj &b)
+{
+	return (a.code + a.ro) > (b.code + b.ro);
+}
+
+
+static bool Map_BySize(const ram_sym &a, const ram_sym &b)
+{
+	return a.size > b.size;
+}
+
+
+/**
+  * Row of a size table: code, inc. data, RO, RW, ZI, debug, name
+  */
+static bool Map_SizeRow(const char *line, ram_obj *o)
+{
+	unsigned long code, inc, ro, rw, zi, dbg;
+	char name[128];
+
+	if (sscanf(line, "%lu %lu %lu %lu %lu %lu %127s", &code, &inc, &ro, &rw, &zi, &dbg, name) != 7) return false;
+	o->name = name;
+	o->code = code;
+	o->ro = ro;
+	o->rw = rw;
+	o->zi = zi;
+	return true;
+}
+
+
+/**
+  * Symbol table row: name, value, [Ov], type, size, object(section)
+  */
+static bool Map_SymRow(const char *line, ram_sym *s)
+{
+	char name[128], type[32], obj[160];
+	unsigned long addr, size;
+	const char *p;
+
+	if (sscanf(line, "%127s 0x%lx %31s %lu %159s", name, &addr, type, &size, obj) != 5)
+		return false;
+	if (strcmp(type, "Data") || (size == 0) || (addr < RAM_BASE) || (addr >= RAM_BASE + 0x10000UL)) return false;
+	p = strchr(obj, '(');
+	s->name = name;
+	s->obj = p ? std::string(obj, p - obj) : std::string(obj);
+	s->addr = addr;
+	s->size = size;
+	return true;
+}
+
+
+int main(int argc, char **argv)
+{
+	std::vector<ram_obj> objs;
+	std::vector<ram_sym> syms;
+	unsigned long total = 0, ram = RAM_SIZE;
+	unsigned int nsyms = 20, i;
+	bool flash = false;
+	const char *file = NULL;
+	char line[512];
+	uint8_t mode = MAP_NONE;
+	FILE *f;
+	ram_obj o;
+	ram_sym s;
+
+	for (i = 1; i < (unsigned int)argc; i++)
+	{
+		if (!strcmp(argv[i], "-c")) flash = true;
+		else if (!strcmp(argv[i], "-n") && (i + 1 < (unsigned int)argc)) nsyms = (unsigned int)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r") && (i + 1 < (unsigned int)argc)) ram = strtoul(argv[++i], NULL, 0);
+		else file = argv[i];
+	}
+	if (file == NULL) { fprintf(stderr, "usage: rammap [-c] [-n symbols] [-r ram_bytes] file.map\n"); return 1; }
+	f = fopen(file, "r");
+	if (f == NULL) { perror(file); return 1; }
+
+	while (fgets(line, sizeof(line), f))
+	{
+		/* objects and library members are counted, library totals are not */
+		if (strstr(line, "Image component sizes")) mode = MAP_SKIP;
+		else if (mode == MAP_NONE)
+		{
+			if (Map_SymRow(line, &s)) syms.push_back(s);
+		}
+		else if (strstr(line, "=====")) mode = MAP_NONE;
+		else if (strstr(line, "Object Name") || strstr(line, "Library Member Name")) mode = MAP_TAKE;
+		else if (strstr(line, "Library Name")) mode = MAP_SKIP;
+		else if ((mode == MAP_TAKE) && Map_SizeRow(line, &o) && (o.name[0] != '(') && !strstr(line, "Totals"))
+			objs.push_back(o);
+	}
+	fclose(f);
+
+	if (objs.empty()) { fprintf(stderr, "%s: no \"Image component sizes\" found\n", file); return 1; }
+
+	if (flash)
+	{
+		std::sort(objs.begin(), objs.end(), Map_ByFlash);
+		printf("%-28s %8s %8s %8s\n", "object / library", "Code", "RO", "flash");
+		for (i = 0; i < objs.size(); i++)
+		{
+			if (objs[i].code + objs[i].ro == 0) continue;
+			printf("%-28s %8lu %8lu %8lu\n", objs[i].name.c_str(), objs[i].code, objs[i].ro, objs[i].code + objs[i].ro);
+			total += objs[i].code + objs[i].ro;
+		}
+		printf("%-28s %8s %8s %8lu\n", "total", "", "", total);
+		return 0;
+	}
+
+	std::sort(objs.begin(), objs.end(), Map_ByRam);
+	printf("%-28s %8s %8s %8s\n", "object / library", "RW", "ZI", "RAM");
+	for (i = 0; i < objs.size(); i++)
+	{
+		if (objs[i].rw + objs[i].zi == 0) continue;
+		printf("%-28s %8lu %8lu %8lu\n", objs[i].name.c_str(), objs[i].rw, objs[i].zi, objs[i].rw + objs[i].zi);
+		total += objs[i].rw + objs[i].zi;
+	}
+	printf("%-28s %8s %8s %8lu of %lu (%.0f%%), %ld free\n", "total", "", "", total, ram,
+	       100.0 * total / ram, (long)ram - (long)total);
+
+	std::sort(syms.begin(), syms.end(), Map_BySize);
+	if (!syms.empty()) printf("\n%-28s %-20s %10s %8s\n", "data symbol", "object", "address", "bytes");
+	for (i = 0; (i < syms.size()) && (i < nsyms); i++)
+		printf("%-28s %-20s 0x%08lx %8lu\n", syms[i].name.c_str(), syms[i].obj.c_str(), syms[i].addr, syms[i].size);
+	return 0;
+}
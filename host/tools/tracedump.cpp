@@ -0,0 +1,132 @@
+/**
+  ******************************************************************************
+  * @file    tracedump.cpp
+  * @author  e.pavlin.si
+  * @brief   Decode the event trace ring from a memory dump
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * The dump is raw little-endian memory: all RAM saved from the debugger
+  * (uVision: SAVE dump.hex 0x20000000,0x20001800 and convert it to binary),
+  * or the trace structure alone as written by fwrun -T. The ring is found
+  * by its magic word. Records are printed oldest first, with time since
+  * the first record and since the previous one. A record whose sequence
+  * byte does not match its position was being overwritten when the dump
+  * was taken.
+  *
+  * usage: tracedump dump.bin
+  *
+  */
+
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static const char *Trace_Name(uint8_t id)
+{
+	switch (id)
+	{
+		case TRC_NONE:       return "none";
+		case TRC_ENC_STEP:   return "encoder";
+		case TRC_ENC_KEY:    return "key";
+		case TRC_AD_SAMPLE:  return "ad sample";
+		case TRC_MENU_EVENT: return "menu event";
+		case TRC_MENU_STATE: return "menu state";
+		case TRC_MARK:       return "mark";
+		case TRC_LCD_DONE:   return "lcd done";
+		case TRC_AD_SETTLED: return "ad settled";
+		case TRC_BOOT_READY: return "boot ready";
+		case TRC_HUM:        return "hum check";
+	}
+	return "?";
+}
+
+
+static void Trace_Arg(char *buf, size_t n, uint8_t id, uint16_t arg)
+{
+	switch (id)
+	{
+		case TRC_ENC_STEP:   snprintf(buf, n, "%s", arg ? "up" : "down"); break;
+		case TRC_ENC_KEY:    buf[0] = 0; break;
+		case TRC_AD_SAMPLE:  snprintf(buf, n, "%u (0x%04x)", arg, arg); break;
+		case TRC_MENU_EVENT: snprintf(buf, n, "signals 0x%02x", arg); break;
+		case TRC_MENU_STATE: snprintf(buf, n, "-> %u", arg); break;
+		default:             snprintf(buf, n, "%u", arg); break;
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	std::vector<uint8_t> mem;
+	trace_buf_t tb;
+	const trace_rec_t *rec;
+	FILE *f;
+	size_t off, len;
+	uint32_t magic, n, count, first, i, t_edge = 0;
+	uint8_t pending = 0;
+	double us;
+	char arg[48];
+
+	if (argc != 2) { fprintf(stderr, "usage: tracedump dump.bin\n"); return 1; }
+	f = fopen(argv[1], "rb");
+	if (f == NULL) { perror(argv[1]); return 1; }
+	fseek(f, 0, SEEK_END);
+	len = (size_t)ftell(f);
+	fseek(f, 0, SEEK_SET);
+	mem.resize(len);
+	if (fread(mem.data(), 1, len, f) != len) { perror(argv[1]); return 1; }
+	fclose(f);
+
+	for (off = 0; off + sizeof(tb) <= len; off += 4)
+	{
+		memcpy(&magic, &mem[off], 4);
+		if (magic == TRACE_MAGIC) break;
+	}
+	if (off + sizeof(tb) > len) { fprintf(stderr, "%s: no trace found\n", argv[1]); return 1; }
+	memcpy(&tb, &mem[off], sizeof(tb));
+	if ((tb.len != TRACE_LEN) || (tb.hz == 0))
+	{
+		fprintf(stderr, "%s: trace at 0x%zx has %u records at %u Hz, expected %u\n",
+		        argv[1], off, tb.len, tb.hz, TRACE_LEN);
+		return 1;
+	}
+
+	us = 1e6 / tb.hz;
+	count = (tb.head < TRACE_LEN) ? tb.head : TRACE_LEN;
+	first = tb.head - count;
+	printf("trace at offset 0x%zx: %u events, %u kept, %.0f Hz, %u ns per event\n",
+	       off, tb.head, count, (double)tb.hz, tb.overhead);
+	printf("%8s %12s %10s  %-12s %s\n", "#", "t [ms]", "dt [us]", "event", "arg");
+
+	for (i = 0; i < count; i++)
+	{
+		n = first + i;
+		rec = &tb.rec[n & (TRACE_LEN - 1)];
+		Trace_Arg(arg, sizeof(arg), rec->id, rec->arg);
+		if ((rec->id == TRC_ENC_STEP) || (rec->id == TRC_ENC_KEY))
+		{
+			if (!pending) t_edge = rec->t;
+			pending = 1;
+		}
+		else if ((rec->id == TRC_LCD_DONE) && pending)
+		{
+			snprintf(arg + strlen(arg), sizeof(arg) - strlen(arg), ", latency %.0f us", (uint32_t)(rec->t - t_edge) * us);
+			pending = 0;
+		}
+		printf("%8u %12.3f %10.1f  %-12s %s%s\n", n,
+		       (uint32_t)(rec->t - tb.rec[first & (TRACE_LEN - 1)].t) * us / 1000.0,
+		       i ? (uint32_t)(rec->t - tb.rec[(n - 1) & (TRACE_LEN - 1)].t) * us : 0.0,
+		       Trace_Name(rec->id), arg, (rec->seq == (uint8_t)n) ? "" : "  (torn)");
+	}
+	return 0;
+}
@@ -0,0 +1,143 @@
+/**
+  ******************************************************************************
+  * @file    hum.c
+  * @author  e.pavlin.si
+  * @brief   Mains hum detector
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * Goertzel recurrence s = x + c * s1 - s2 with c = 2 cos(2 pi k / N) in
+  * Q14; after the block |X|^2 = s1^2 + s2^2 - c * s1 * s2 and the peak
+  * amplitude is 2 |X| / N. The state stays within 32 bits for full scale
+  * input, the products are taken in 64 bits.
+  *
+  */
+
+#include "hum.h"
+
+/** 2 cos(2 pi f / HUM_FS_HZ), Q14 */
+static const int32_t hum_coeff[2] = { 26510, 23887 };
+
+/** 1 / sinc^3(f / HUM_FS_HZ), Q14: AD7715 filter loss at the detector rate */
+static const int32_t hum_gain[2] = { 17216, 17597 };
+
+/** Last result */
+hum_result_t Hum;
+
+
+static uint32_t Hum_Sqrt(uint64_t x)
+{
+	uint64_t r = 0, b = (uint64_t)1 << 62;
+
+	while (b > x) b >>= 2;
+	while (b)
+	{
+		if (x >= r + b)
+		{
+			x -= r + b;
+			r = (r >> 1) + b;
+		}
+		else r >>= 1;
+		b >>= 2;
+	}
+	return (uint32_t)r;
+}
+
+
+/**
+  * Peak amplitude seen by detector i, codes Q16.8
+  */
+static uint32_t Hum_Amplitude(const hum_det_t *d, uint8_t i)
+{
+	int64_t s1 = d->s1[i], s2 = d->s2[i];
+	int64_t p;
+	uint32_t a;
+
+	p = s1 * s1 + s2 * s2 - ((hum_coeff[i] * s1 * s2) >> 14);
+	if (p < 0) p = 0;
+	a = (uint32_t)(((uint64_t)Hum_Sqrt((uint64_t)p) * (2 << 8)) / HUM_N);
+	return (uint32_t)(((uint64_t)a * hum_gain[i]) >> 14);
+}
+
+
+void Hum_Start(hum_det_t *d)
+{
+	d->s1[0] = d->s1[1] = 0;
+	d->s2[0] = d->s2[1] = 0;
+	d->n = 0;
+}
+
+
+/**
+  * Add one conversion, 1 when the block is complete
+  */
+uint8_t Hum_Sample(hum_det_t *d, uint16_t rd)
+{
+	int32_t x, s;
+	uint8_t i;
+
+	if (d->n >= HUM_N) return 1;
+	if (d->n == 0) d->ref = rd;
+	x = (int32_t)rd - (int32_t)d->ref;
+	for (i = 0; i < 2; i++)
+	{
+		s = x + (int32_t)(((int64_t)hum_coeff[i] * d->s1[i]) >> 14) - d->s2[i];
+		d->s2[i] = d->s1[i];
+		d->s1[i] = s;
+	}
+	return (++d->n >= HUM_N) ? 1 : 0;
+}
+
+
+/**
+  * Output rate for a complete block: the notch of the stronger frequency
+  * if it is above HUM_MIN_Q8 and HUM_RATIO times the other, else fs as is
+  */
+uint8_t Hum_Decide(const hum_det_t *d, uint8_t fs)
+{
+	uint8_t prev = fs;
+
+	Hum.amp_q8[HUM_50HZ] = Hum_Amplitude(d, HUM_50HZ);
+	Hum.amp_q8[HUM_60HZ] = Hum_Amplitude(d, HUM_60HZ);
+
+	if ((Hum.amp_q8[HUM_60HZ] >= HUM_MIN_Q8) &&
+	    (Hum.amp_q8[HUM_60HZ] >= HUM_RATIO * Hum.amp_q8[HUM_50HZ]))
+		fs = AD7715_FS_60HZ;
+	else if ((Hum.amp_q8[HUM_50HZ] >= HUM_MIN_Q8) &&
+	         (Hum.amp_q8[HUM_50HZ] >= HUM_RATIO * Hum.amp_q8[HUM_60HZ]))
+		fs = AD7715_FS_50HZ;
+
+	Hum.fs = fs;
+	Hum.changed = (fs != prev) ? 1 : 0;
+	Hum.rejected_q8 = Hum.amp_q8[(fs == AD7715_FS_60HZ) ? HUM_60HZ : HUM_50HZ];
+	Hum.runs++;
+	return fs;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file     hum.h
+ * @brief    Mains hum detector Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     AD7715_Thread switches the converter to HUM_FS_HZ for one block
+ *           of HUM_N conversions and feeds them to two Goertzel filters,
+ *           at 50 and 60 Hz. With HUM_N = 50 both frequencies fall on
+ *           whole bins (5 and 6), so neither leaks into the other.
+ *           Hum_Decide() then picks the output rate whose sinc notch
+ *           matches the stronger one.
+ *
+ *           Amplitudes are peak, in ADC codes Q16.8, corrected for the
+ *           AD7715 filter response at HUM_FS_HZ, so they are what the
+ *           notch has to reject. The last result is in Hum for the
+ *           debugger.
+ *
+ */
+
+#ifndef ___HUM_H_
+#define ___HUM_H_
+
+#include <stdint.h>
+#include "ad7715.h"
+
+/** \brief Detector output rate */
+#define HUM_FS							AD7715_FS_500HZ
+#define HUM_FS_HZ						500
+
+/** \brief Conversions per block, and conversions skipped after the rate
+ *         change while the filter settles */
+#define HUM_N								50
+#define HUM_SKIP						3
+
+/** \brief Interval of the check after the one at start-up, s */
+#define HUM_PERIOD_S				600
+
+/** \brief Weakest hum acted on, codes Q16.8 */
+#define HUM_MIN_Q8					(2 << 8)
+
+/** \brief The other frequency must be this many times weaker */
+#define HUM_RATIO						2
+
+/** \brief Detectors */
+#define HUM_50HZ						0
+#define HUM_60HZ						1
+
+/** \brief One block in progress */
+typedef struct
+{
+	int32_t s1[2];					/*!< Goertzel state, per detector */
+	int32_t s2[2];
+	uint16_t ref;						/*!< first conversion, removed as DC */
+	uint8_t n;							/*!< conversions so far */
+} hum_det_t;
+
+/** \brief Result of the last check */
+typedef struct
+{
+	uint32_t amp_q8[2];			/*!< hum amplitude per detector, codes Q16.8 */
+	uint32_t rejected_q8;		/*!< amplitude at the chosen notch */
+	uint8_t fs;							/*!< chosen AD7715_FS_50HZ or AD7715_FS_60HZ */
+	uint8_t changed;				/*!< fs differs from before the check */
+	uint16_t runs;
+} hum_result_t;
+
+extern hum_result_t Hum;
+
+void Hum_Start(hum_det_t *d);
+uint8_t Hum_Sample(hum_det_t *d, uint16_t rd);
+uint8_t Hum_Decide(const hum_det_t *d, uint8_t fs);
+
+#endif
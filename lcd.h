@@ -6,7 +6,7 @@ void LCD_Init(uint8_t cols, uint8_t rows);
 void LCD_DisplayOn(void);
 void LCD_DisplayOff(void);
 void LCD_Clear(void);
-void LCD_Puts(uint8_t x, uint8_t y, char* str);
+void LCD_Puts(uint8_t x, uint8_t y, const char *str);
 void LCD_BlinkOn(void);
 void LCD_BlinkOff(void);
 void LCD_CursorOn(void);
@@ -14,6 +14,7 @@ void LCD_CursorOff(void);
 void LCD_ScrollLeft(void);
 void LCD_ScrollRight(void);
 void LCD_CreateChar(uint8_t location, uint8_t* data);
+void LCD_SetCharRows(uint8_t location, uint8_t row, uint8_t n, const uint8_t *data);
 void LCD_PutCustom(uint8_t x, uint8_t y, uint8_t location);
 uint8_t HD4478_initialized(void);
 
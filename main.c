@@ -38,6 +38,16 @@
 #define osObjectsPublic                     // define objects in main module
 #include "osObjects.h"                      // RTOS object definitions
 #include "stm32f0xx.h"                  // Device header
+#include "prof.h"
+#include "trace.h"
+#include "stkmon.h"
+#include "timebase.h"
+#include "cpuload.h"
+#include "rtmon.h"
+#include "sched.h"
+#include "ad7715.h"
+#include "measure.h"
+#include "trend.h"
 
 /**
   * External references: Init, etc... 
@@ -47,7 +57,8 @@ extern int Init_LCD_Thread (void);
 extern int Init_AD7715_Thread (void);
 extern void Encoder_Init(void);
 extern int Init_Measure_Thread (void);
-extern void LCD_Init(uint8_t cols, uint8_t rows);
+extern void Temp_Init(void);
+extern void Cal_Init(void);
 
 /*----------------------------------------------------------------------------
  * SystemCoreClockConfigure: configure SystemCoreClock using HSI
@@ -94,21 +105,58 @@ void SystemCoreClockConfigure(void) {
  * main: initialize and start the system
  */
 int main (void) {
+	int32_t sig;
+	uint8_t i;
+
   osKernelInitialize ();                    // initialize CMSIS-RTOS
 
   // initialize peripherals 
   SystemCoreClockConfigure();                              // configure System Clock
   SystemCoreClockUpdate();
+	Tb_Init();                                // microsecond timebase
+	Temp_Init();
+	Cal_Init();
 
- 	LCD_Init(16,2);
-	Init_AD7715_Thread();
+	Init_AD7715_Thread();                     // reset and self-calibration ...
 	Encoder_Init();
-	Init_Measure_Thread();
+	Init_Measure_Thread();                    // ... while this one brings up the LCD
+	Sched_Init();                             // periodic jobs
 
   osKernelStart ();                         // start thread execution 
+	PROF_INIT();                              // calibrate profiling counters
+	TRACE_INIT();                             // clear event trace
+	Stk_Register(STK_MAIN, STK_MAIN_SIZE);    // main thread stack watermark
+	osThreadSetPriority(osThreadGetId(), RT_PRIO_LOG);
+	Sched_Join(SCHED_LOG);
+	Sched_Join(SCHED_DIAG);
+	Sched_Join(SCHED_TREND);
+	Rt_Declare(RT_JOB_LOG, Sched_PeriodUs(SCHED_LOG), LOAD_DEADLINE_MS * 1000UL);
+	Rt_Declare(RT_JOB_DIAG, Sched_PeriodUs(SCHED_DIAG), Sched_PeriodUs(SCHED_DIAG));
+	Rt_Declare(RT_JOB_TREND, Sched_PeriodUs(SCHED_TREND), Sched_PeriodUs(SCHED_TREND));
+	Load_Run(LOAD_MAIN);
 	
 	while (1)
 	{
-		osThreadYield (); 
+		Load_Block(LOAD_MAIN);
+		sig = osSignalWait(0, osWaitForever).value.signals;
+		Load_Run(LOAD_MAIN);
+		if (sig & SCHED_SIG(SCHED_LOG))
+		{
+			Rt_Start(RT_JOB_LOG, Sched_Release(SCHED_LOG));
+			Load_Update();                        // CPU utilization of the last window
+			Rt_End(RT_JOB_LOG);
+		}
+		if (sig & SCHED_SIG(SCHED_DIAG))
+		{
+			Rt_Start(RT_JOB_DIAG, Sched_Release(SCHED_DIAG));
+			for (i = 0; i < STK_NTHREADS; i++) Stk_Scan(i);   // free stack, for the debugger
+			Rt_End(RT_JOB_DIAG);
+		}
+		if (sig & SCHED_SIG(SCHED_TREND))
+		{
+			Rt_Start(RT_JOB_TREND, Sched_Release(SCHED_TREND));
+			if (AD7715_SettledTime()) Trend_Sample(M_pH(AD7715_ReadoutQ8()));
+			Rt_End(RT_JOB_TREND);
+		}
 	}
 }
@@ -2,9 +2,21 @@
 #include "lcd.h"
 #include "encoder.h"
 #include "ad7715.h"
-#include <stdio.h>
-#include <math.h>
-#include <stdlib.h>
+#include "titration.h"
+#include "tempcomp.h"
+#include "calib.h"
+#include "measure.h"
+#include "fmt.h"
+#include "menu.h"
+#include "prof.h"
+#include "trace.h"
+#include "stkmon.h"
+#include "cpuload.h"
+#include "timebase.h"
+#include "rtmon.h"
+#include "sched.h"
+#include "stats.h"
+#include "trend.h"
 
 /*----------------------------------------------------------------------------
  *      Main measurement thread
@@ -22,27 +34,29 @@ typedef enum
 	M_CAL3_T2,
 	M_CAL3_T3,
 	M_CAL3_EXIT,
+	M_MENU_TITR,
+	M_TITR,
+	M_MENU_STAT,
+	M_STAT,
+	M_STAT_HOLD,
+	M_MENU_TREND,
+	M_TREND,
 	M_MENU_EXIT,
+	M_NSTATES                            // number of states, entries in M_Menu
 	
 } Measure_state_t;
 
 
-#define UP 1
-#define DN 2
-
-typedef struct
-{
-	uint16_t AD_point[3];
-  uint16_t refpoint[3]; 	
-} meas_cal_t;
-
-
-static meas_cal_t M_cal;
-static Measure_state_t MS = M_MEASURE;
+static uint8_t MS = M_MEASURE;
+static uint32_t boot_us;               // Tb_Us() when the first settled pH was shown
+static uint8_t ph_dec = 2;             // decimals of the pH readout
+static uint8_t cal_pt;                 // calibration point being edited
+static uint16_t stat_win = STATS_NWIN - 1;  // statistics window, STATS_WIN() index
+static stats_result_t stat_hold;       // statistics frozen by HOLD
  
 void Measure_Thread (void const *argument);                  // thread function
 osThreadId tid_Measure_Thread;                               // thread id
-osThreadDef (Measure_Thread, osPriorityNormal, 1, 1024);     // thread object
+osThreadDef (Measure_Thread, RT_PRIO_UI, 1, 824);            // thread object
 
 int Init_Measure_Thread (void) {
 
@@ -54,39 +68,40 @@ int Init_Measure_Thread (void) {
   return(0);
 }
 
-void M_Load_Default_Cal(meas_cal_t *cal)
+/**
+  * Time from Tb_Init() to the first settled pH on the display, us; 0 before
+  */
+uint32_t M_BootTime(void)
 {
-	/* 3 point cal */
-	cal->AD_point[0] = 30610;  cal->refpoint[0] = 4000;
-	cal->AD_point[1] = 26650;  cal->refpoint[1] = 7000;
-	cal->AD_point[2] = 23940;  cal->refpoint[2] = 9000;
-
-  /* 2 point cal */
-	cal->AD_point[0] = 30610;  cal->refpoint[0] = 4000;
-	cal->AD_point[1] = 23940;  cal->refpoint[1] = 9000;
-	cal->AD_point[2] = 0;  cal->refpoint[2] = 0;
-
+	return boot_us;
 }
 
-uint16_t M_pH(uint16_t adc)
+/**
+  * Calibrated and temperature compensated pH, 0.001 pH, from an ADC code
+  * with AD7715_FRAC fraction bits
+  */
+uint16_t M_pH(uint32_t adc)
 {
-	double x0, x1, y0, y1, y;
-  if ((M_cal.AD_point[2] == 0)
-       | (adc <  M_cal.AD_point[1]) )		// 2 point calibration or lower segment
-	{
-		x0 = M_cal.AD_point[0]; y0 = M_cal.refpoint[0];
-		x1 = M_cal.AD_point[1]; y1 = M_cal.refpoint[1];
-		y = y0 + ((y1 - y0) / (x1 - x0)) * (((double)adc) - x0);
-	}
-	else  // 3 point calibration --- upper segment
-	{
-		x0 = M_cal.AD_point[1]; y0 = M_cal.refpoint[1];
-		x1 = M_cal.AD_point[2]; y1 = M_cal.refpoint[2];
-		y = y0 + ((y1 - y0) / (x1 - x0)) * (((double)adc) - x0);
-	}
+	int32_t y;
+
+	PROF_START(PROF_M_PH);
+	y = Temp_Compensate(Cal_pH(adc));
   if (y<0) y = 0;
 	if (y>14000) y = 14000;
-	return (uint16_t) (y /10);
+	PROF_STOP(PROF_M_PH);
+	return (uint16_t) y;
+}
+
+/**
+  * Effective resolution at ADC code adc (Q16.8), 0.001 pH: how far one 
+  * sigma of readout noise moves the pH there
+  */
+uint16_t M_Resolution(uint32_t adc)
+{
+	int32_t a = M_pH(adc);
+	int32_t b = M_pH(adc + AD7715_NoiseQ8());
+
+	return (uint16_t)((b > a) ? (b - a) : (a - b));
 }
 
 void cls(void)
@@ -98,104 +113,184 @@ void cls(void)
 
 void Update_Readout(uint8_t raw)
 {
-	int16_t adc, ph; 
-	char str[17];
+	uint32_t adc;
+	uint16_t ph, res;
+	char str[17], *p, *e = str + 16;
 
-	adc = AD7715_Readout();
-	ph = M_pH(adc);
+	PROF_START(PROF_READOUT);
+	adc = AD7715_ReadoutQ8();
 	if (raw)
 	{
-		snprintf(str, 16, "AD:%d     ", adc);
+		p = Fmt_Str(str, e, "AD:", 0);
+		p = Fmt_Uint(p, e, AD7715_Readout(), 0, ' ');
+	}
+	else
+	{
+		// third decimal only while the noise allows it
+		ph = M_pH(adc);
+		res = M_Resolution(adc);
+		if (res <= M_RES_3DEC) ph_dec = 3;
+		else if (res > 2 * M_RES_3DEC) ph_dec = 2;
+		p = Fmt_Str(str, e, "pH:", 0);
+		if (ph_dec == 3)
+			p = Fmt_Fixed(p, e, ph, 3, 0);
+		else
+			p = Fmt_Fixed(p, e, (ph + 5) / 10, 2, 0);
+	}
+	LCD_Puts(0,0,Fmt_Fill(str, p, 16));
+	PROF_STOP(PROF_READOUT);
+}
+
+/**
+  * Temperature readout on second line
+  */
+void Update_Temperature(void)
+{
+	char str[17], *p, *e = str + 16;
+
+	p = Fmt_Str(str, e, "T:", 0);
+	p = Fmt_Fixed(p, e, Temp_C10(), 1, 0);
+	p = Fmt_Char(p, e, 'C');
+	if (!Temp_Valid()) p = Fmt_Char(p, e, '?');
+	LCD_Puts(0,1,Fmt_Fill(str, p, 16));
+}
+
+/**
+  * Titration display: last point pH, number of endpoints,
+  * measured conversion rate and dropped conversions
+  */
+void Update_Titration(void)
+{
+	const titr_status_t *ts = Titration_Status();
+	titr_point_t pt;
+	char str[17], *p, *e = str + 16;
+
+	p = Fmt_Str(str, e, "pH:", 0);
+	if (Titration_GetPoint(0, &pt))
+	{
+		p = Fmt_Fixed(p, e, pt.ph, 2, 5);
+	}
+	else
+	{
+		p = Fmt_Str(p, e, "--.--", 0);
+	}
+	p = Fmt_Str(p, e, " EP:", 0);
+	p = Fmt_Uint(p, e, ts->n_ep, 0, ' ');
+	LCD_Puts(0,0,Fmt_Fill(str, p, 16));
+
+	p = Fmt_Str(str, e, "R:", 0);
+	p = Fmt_Uint(p, e, ts->rate_hz, 0, ' ');
+	p = Fmt_Str(p, e, "Hz D:", 0);
+	/* what is left of the line; a cut count would read as a smaller one */
+	if (ts->dropped > 9999)
+		p = Fmt_Str(p, e, ">9999", 0);
+	else
+		p = Fmt_Uint(p, e, ts->dropped, 0, ' ');
+	LCD_Puts(0,1,Fmt_Fill(str, p, 16));
+}
+
+/**
+  * Statistics of the window: mean and standard deviation on the first
+  * line, pH range on the second, or the conversions so far while the
+  * window fills. H marks a held result.
+  */
+void Update_Stats(const stats_result_t *st, uint8_t hold)
+{
+	uint16_t ph, lo, hi;
+	char str[17], *p, *e = str + 16;
+
+	ph = M_pH(st->mean_q8);
+	p = Fmt_Str(str, e, "X:", 0);
+	p = Fmt_Fixed(p, e, ph, 3, 0);
+	p = Fmt_Str(p, e, " S:", 0);
+	lo = M_pH(st->mean_q8 + st->sd_q8);
+	p = Fmt_Fixed(p, e, (lo > ph) ? (lo - ph) : (ph - lo), 3, 0);
+	LCD_Puts(0,0,Fmt_Fill(str, p, 16));
+
+	if (st->n < st->len)
+	{
+		p = Fmt_Str(str, e, "N:", 0);
+		p = Fmt_Uint(p, e, st->n, 0, ' ');
+		p = Fmt_Char(p, e, '/');
+		p = Fmt_Uint(p, e, st->len, 0, ' ');
 	}
 	else
 	{
-	  snprintf(str, 16, "pH:%d.%02d     ", ph/100, ph % 100);
+		lo = M_pH((uint32_t)st->min << AD7715_FRAC);
+		hi = M_pH((uint32_t)st->max << AD7715_FRAC);
+		if (lo > hi)
+		{
+			ph = lo; lo = hi; hi = ph;
+		}
+		p = Fmt_Fixed(str, e, lo, 3, 0);
+		p = Fmt_Char(p, e, '-');
+		p = Fmt_Fixed(p, e, hi, 3, 0);
 	}
-	LCD_Puts(0,0,str);
+	if (hold) p = Fmt_Str(p, e, " H", 0);
+	LCD_Puts(0,1,Fmt_Fill(str, p, 16));
+}
+
+/**
+  * DoCal helpers: draw edited values
+  */
+static void M_ShowRef(uint16_t refpoint)
+{
+	char str[17], *p, *e = str + 16;
+
+	p = Fmt_Str(str, e, "Ref pH:", 0);
+	p = Fmt_Fixed(p, e, refpoint, 3, 0);
+	LCD_Puts(0,1,Fmt_Fill(str, p, 16));
+}
+
+static void M_ShowConfirm(uint16_t ok)
+{
+	char str[17], *p, *e = str + 16;
+
+	p = Fmt_Str(str, e, "Ref. pH(", 0);
+	p = Fmt_Uint(p, e, cal_pt, 0, ' ');
+	p = Fmt_Str(p, e, (ok==1) ? ") OK" : ") NIOK", 0);
+	LCD_Puts(0,0,Fmt_Fill(str, p, 16));
+}
+
+static void M_ShowSave(uint16_t dn)
+{
+	LCD_Puts(11,0,(dn==1) ? " DA " : " NE ");
 }
 
+
 void DoCal(uint8_t NumPts, uint8_t Pt)
 {
-  osEvent evt;
-	uint8_t updn = 0, ok = 1, dn = 0;
+	uint16_t ok = 1, dn = 0;
 	uint16_t refpoint, adc1, adc2, stable, diff, i;
+	cal_points_t cal;
 	
-	char str[17];
+	char str[17], *p, *e = str + 16;
 	
-	refpoint = M_cal.refpoint[Pt-1];
+	cal_pt = Pt;
+	Cal_Get(&cal);
+	refpoint = cal.refpoint[Pt-1];
 	
 	// Set value
-	snprintf(str, 16, "Ref. pH(%d)      ",Pt); 
-	LCD_Puts(0,0,str);
-	while (1)
-	{
-		// handle encoder signals  
-	  evt = osSignalWait (ENCODER_BUTTON, 0);
-		if (evt.status == osEventSignal) break; 
-		
-	  evt = osSignalWait (ENCODER_UP, 0);
-		if (evt.status == osEventSignal) updn = UP; 
-		
-	  evt = osSignalWait (ENCODER_DN, 0);
-		if (evt.status == osEventSignal) updn = DN; 
-    
-		snprintf(str, 16, "Ref pH:%d.%03d       ", refpoint/1000, refpoint % 1000);
-		LCD_Puts(0,1,str);
-		
-		if (updn == DN) 
-		{
-			if (refpoint > 0) refpoint--;
-		}
-		if (updn == UP) 
-		{
-			if (refpoint < 14000) refpoint++;
-		}
-		updn = 0;
-		osThreadYield ();
-		
-	}
+	p = Fmt_Str(str, e, "Ref. pH(", 0);
+	p = Fmt_Uint(p, e, Pt, 0, ' ');
+	p = Fmt_Char(p, e, ')');
+	LCD_Puts(0,0,Fmt_Fill(str, p, 16));
+	Menu_Edit(&refpoint, 14000, 0, M_ShowRef);
 
 	// confirm ref. value
-	while (1)
-	{
-		// handle encoder signals  
-	  evt = osSignalWait (ENCODER_BUTTON, 0);
-		if (evt.status == osEventSignal) break; 
-		
-	  evt = osSignalWait (ENCODER_UP, 0);
-		if (evt.status == osEventSignal) updn = UP; 
-		
-	  evt = osSignalWait (ENCODER_DN, 0);
-		if (evt.status == osEventSignal) updn = DN; 
-		
-		if (ok==1)
-		{
-		  snprintf(str, 16, "Ref. pH(%d) OK   ",Pt); 
-		}
-		else
-		{
-			snprintf(str, 16, "Ref. pH(%d) NIOK ",Pt);
-		}
-	  LCD_Puts(0,0,str);
-
-		snprintf(str, 16, "Ref pH:%d.%02d       ", refpoint/100, refpoint % 100);
-		if (updn != 0) 
-		{
-			if (ok==1) ok=0; else ok=1;
-		}		
-		updn = 0;
-		osThreadYield ();
-	}
+	Menu_Edit(&ok, 1, 1, M_ShowConfirm);
 	cls();
 	
 	if (ok == 1)
 	{
 		// read ADC
-	  snprintf(str, 17, "Ref. pH(%d) - CAL",Pt); 
-	  LCD_Puts(0,0,str);
+		p = Fmt_Str(str, e, "Ref. pH(", 0);
+		p = Fmt_Uint(p, e, Pt, 0, ' ');
+		p = Fmt_Str(p, e, ") - CAL", 0);
+	  LCD_Puts(0,0,Fmt_Fill(str, p, 16));
 		
 		stable = 0;
-		adc2 = AD7715_Readout();
+		adc1 = adc2 = AD7715_Readout();
 		// wait for stable result
 		while(1)
 		{
@@ -203,8 +298,11 @@ void DoCal(uint8_t NumPts, uint8_t Pt)
 			for (i = 0; i<100; i++)
 			{
 				adc1 = AD7715_Readout();
-				snprintf(str, 16, "AD:%d, S:%d  ", adc1, stable);
-				LCD_Puts(0,1,str);
+				p = Fmt_Str(str, e, "AD:", 0);
+				p = Fmt_Uint(p, e, adc1, 0, ' ');
+				p = Fmt_Str(p, e, ", S:", 0);
+				p = Fmt_Uint(p, e, stable, 0, ' ');
+				LCD_Puts(0,1,Fmt_Fill(str, p, 16));
 				if (adc1 > adc2) diff += adc1-adc2; else diff += adc2 - adc1;
 				adc2 = adc1;
 				i++;
@@ -213,61 +311,30 @@ void DoCal(uint8_t NumPts, uint8_t Pt)
 			if (diff < 5) stable++; else stable = 0;
 			if (stable > 100) break;
       	
-			// handle encoder signals  
-			evt = osSignalWait (ENCODER_BUTTON, 0);
-			if (evt.status == osEventSignal) 
+			if (Menu_WaitEvent(1) & MENU_EV_SELECT) 
 			{ // cancel the process
 				ok = 0;
 			  break; 
 			}
-			osThreadYield ();
 		}
 		
 		if (ok)
 		{
 			cls();
-			// Write to flash?
-			snprintf(str, 16, "Shranim ?"); 
-	    LCD_Puts(0,0,str);
+			// Use the point? The calibration is kept in RAM only
+	    LCD_Puts(0,0,"Shranim ?");
 			
-			snprintf(str, 16, "T(%d),AD=%d     ", Pt,adc1);
-			LCD_Puts(0,1,str);
+			p = Fmt_Str(str, e, "T(", 0);
+			p = Fmt_Uint(p, e, Pt, 0, ' ');
+			p = Fmt_Str(p, e, "),AD=", 0);
+			p = Fmt_Uint(p, e, adc1, 0, ' ');
+			LCD_Puts(0,1,Fmt_Fill(str, p, 16));
 			
-			while (1)
-			{
-				// handle encoder signals  
-				evt = osSignalWait (ENCODER_BUTTON, 0);
-				if (evt.status == osEventSignal) break; 
-				
-				evt = osSignalWait (ENCODER_UP, 0);
-				if (evt.status == osEventSignal) updn = UP; 
-				
-				evt = osSignalWait (ENCODER_DN, 0);
-				if (evt.status == osEventSignal) updn = DN; 
-
-
-				if (dn==1)
-				{
-					LCD_Puts(11,0," DA "); 
-				}
-				else
-				{
-					LCD_Puts(11,0," NE ");
-				}
-
-				if (updn != 0) 
-				{
-					if (dn==1) dn=0; else dn=1;
-				}		
-				updn = 0;
-				
-			  osThreadYield ();
-			}
+			Menu_Edit(&dn, 1, 1, M_ShowSave);
 			
 			if (dn == 1)
 			{
-				// Store to flash
-				
+				Cal_SetPoint(NumPts, Pt-1, adc1, refpoint, Temp_C10());
 			}
 			
 		}
@@ -277,124 +344,147 @@ void DoCal(uint8_t NumPts, uint8_t Pt)
 }
 
 
+/**
+  * Menu screens and actions
+  */
+static void M_ShowMeasure(void)
+{
+	Update_Readout(0);
+	Update_Temperature();
+}
+
+static void M_ShowRaw(void)
+{
+	Update_Readout(1);
+}
+
+static void M_CalAction(uint8_t arg)
+{
+	DoCal(arg >> 4, arg & 0x0F);
+}
+
+static void M_TitrStart(uint8_t arg)
+{
+	Titration_Start();
+}
+
+static void M_TitrStop(uint8_t arg)
+{
+	Titration_Stop();
+}
+
+static void M_ShowWindow(uint16_t win)
+{
+	char str[17], *p, *e = str + 16;
+
+	p = Fmt_Str(str, e, "Okno: ", 0);
+	p = Fmt_Uint(p, e, STATS_WIN(win), 0, ' ');
+	LCD_Puts(0,1,Fmt_Fill(str, p, 16));
+}
+
+static void M_StatStart(uint8_t arg)
+{
+	char str[17], *e = str + 16;
+
+	LCD_Puts(0,0,Fmt_Fill(str, Fmt_Str(str, e, "Statistika", 0), 16));
+	Menu_Edit(&stat_win, STATS_NWIN - 1, 1, M_ShowWindow);
+	Stats_SetWindow(STATS_WIN(stat_win));
+}
+
+static void M_ShowStats(void)
+{
+	stats_result_t st;
+
+	Stats_Get(&st);
+	Update_Stats(&st, 0);
+}
+
+static void M_StatHold(uint8_t arg)
+{
+	Stats_Get(&stat_hold);
+}
+
+static void M_ShowHold(void)
+{
+	Update_Stats(&stat_hold, 1);
+}
+
+static void M_ShowTrend(void)
+{
+	Update_Readout(0);
+	Trend_Draw();
+}
+
+static void M_TrendStart(uint8_t arg)
+{
+	Trend_Invalidate();
+}
+
+
+/**
+  * Menu table, one entry per Measure_state_t in the same order.
+  *   render, label, UP, DN, button, action, arg
+  */
+static const menu_item_t M_Menu[] =
+{
+	/* M_MEASURE    */ { M_ShowMeasure,     0,                  MENU_STAY,     MENU_STAY,     M_MENU_CAL2,   0,             0    },
+	/* M_MENU_CAL2  */ { M_ShowRaw,         "2 tockovna kal.",  M_MENU_EXIT,   M_MENU_CAL3,   M_CAL2_T1,     0,             0    },
+	/* M_CAL2_T1    */ { M_ShowRaw,         "2T Kal: Tocka 1",  M_CAL2_EXIT,   M_CAL2_T2,     MENU_STAY,     M_CalAction,   0x21 },
+	/* M_CAL2_T2    */ { M_ShowRaw,         "2T Kal: Tocka 2",  M_CAL2_T1,     M_CAL2_EXIT,   MENU_STAY,     M_CalAction,   0x22 },
+	/* M_CAL2_EXIT  */ { M_ShowRaw,         "2T Kal: Izhod",    M_CAL2_T2,     M_CAL2_T1,     M_MENU_CAL2,   0,             0    },
+	/* M_MENU_CAL3  */ { M_ShowRaw,         "3 tockovna kal.",  M_MENU_CAL2,   M_MENU_TITR,   M_CAL3_T1,     0,             0    },
+	/* M_CAL3_T1    */ { M_ShowRaw,         "3T Kal: Tocka 1",  M_CAL3_EXIT,   M_CAL3_T2,     MENU_STAY,     M_CalAction,   0x31 },
+	/* M_CAL3_T2    */ { M_ShowRaw,         "3T Kal: Tocka 2",  M_CAL3_T1,     M_CAL3_T3,     MENU_STAY,     M_CalAction,   0x32 },
+	/* M_CAL3_T3    */ { M_ShowRaw,         "3T Kal: Tocka 3",  M_CAL3_T2,     M_CAL3_EXIT,   MENU_STAY,     M_CalAction,   0x33 },
+	/* M_CAL3_EXIT  */ { M_ShowRaw,         "3T Kal: Izhod",    M_CAL3_T3,     M_CAL3_T1,     M_MENU_CAL3,   0,             0    },
+	/* M_MENU_TITR  */ { M_ShowRaw,         "Titracija",        M_MENU_CAL3,   M_MENU_STAT,   M_TITR,        M_TitrStart,   0    },
+	/* M_TITR       */ { Update_Titration,  0,                  MENU_STAY,     MENU_STAY,     M_MENU_TITR,   M_TitrStop,    0    },
+	/* M_MENU_STAT  */ { M_ShowRaw,         "Statistika",       M_MENU_TITR,   M_MENU_TREND,  M_STAT,        M_StatStart,   0    },
+	/* M_STAT       */ { M_ShowStats,       0,                  MENU_STAY,     MENU_STAY,     M_STAT_HOLD,   M_StatHold,    0    },
+	/* M_STAT_HOLD  */ { M_ShowHold,        0,                  M_STAT,        M_STAT,        M_MENU_STAT,   0,             0    },
+	/* M_MENU_TREND */ { M_ShowRaw,         "Trend",            M_MENU_STAT,   M_MENU_EXIT,   M_TREND,       M_TrendStart,  0    },
+	/* M_TREND      */ { M_ShowTrend,       0,                  MENU_STAY,     MENU_STAY,     M_MENU_TREND,  0,             0    },
+	/* M_MENU_EXIT  */ { M_ShowRaw,         "Izhod",            M_MENU_TREND,  M_MENU_CAL2,   M_MEASURE,     0,             0    },
+};
+
+/** Compile error if a state has no menu entry or an entry has no state */
+typedef char m_menu_size[(sizeof M_Menu / sizeof M_Menu[0] == M_NSTATES) ? 1 : -1];
+
+
 void Measure_Thread (void const *argument) {
 
-  osEvent evt;
-	uint8_t baton = 0, updn = 0;
+	uint32_t ev;
+	uint8_t ms;
 
-	while (HD4478_initialized() == 0) osThreadYield ();  // wait for LCD init
+	Stk_Register(STK_MEASURE, (osThread(Measure_Thread))->stacksize);
+	
+	// LCD_Init() sleeps in its delays, AD7715_Thread self-calibrates meanwhile
+	LCD_Init(16,2);
 	LCD_Puts(0,0,"pH meter....");
 	LCD_Puts(3,1,"... init...");
-	M_Load_Default_Cal(&M_cal);
 	
-	osDelay(1000);
+	while (AD7715_SettledTime() == 0) osDelay(M_BOOT_POLL_MS);
 	LCD_Clear();
-	osDelay(100);
+	Menu_Render(M_Menu, MS);
+	boot_us = Tb_Us();
+	TRACE_EVT(TRC_BOOT_READY, boot_us / 1000);
 	
+	Sched_Join(SCHED_DISPLAY);
+	Rt_Declare(RT_JOB_UI, Sched_PeriodUs(SCHED_DISPLAY), M_UI_DEADLINE_MS * 1000UL);
+	Load_Run(LOAD_MEASURE);
   while (1) {
-		// handle encoder signals
-	  evt = osSignalWait (ENCODER_BUTTON, 0);
-		if (evt.status == osEventSignal) baton = 1; 
-		
-	  evt = osSignalWait (ENCODER_UP, 0);
-		if (evt.status == osEventSignal) updn = UP; 
-		
-	  evt = osSignalWait (ENCODER_DN, 0);
-		if (evt.status == osEventSignal) updn = DN; 
-		
-		switch (MS)
-		{
-			case M_MEASURE :
-        Update_Readout(0);	
-				LCD_Puts(0,1,"                ");			
-			  if (baton == 1) MS = M_MENU_CAL2;
-			break;
-			
-			case M_MENU_CAL2 :
-				Update_Readout(1);
-				LCD_Puts(0,1,"2 tockovna kal. ");
-			  if (updn == UP) MS = M_MENU_EXIT;
-			  if (updn == DN) MS = M_MENU_CAL3;
-			  if (baton == 1) MS = M_CAL2_T1;
-			break;
-
-			case M_MENU_CAL3 :
-				Update_Readout(1);
-				LCD_Puts(0,1,"3 tockovna kal. ");
-			  if (updn == UP) MS = M_MENU_CAL2;
-			  if (updn == DN) MS = M_MENU_EXIT;			
-			  if (baton == 1) MS = M_CAL3_T1;
-			break;
-
-			case M_MENU_EXIT :
-				Update_Readout(1);
-				LCD_Puts(0,1,"Izhod           ");
-			  if (updn == UP) MS = M_MENU_CAL3;
-			  if (updn == DN) MS = M_MENU_CAL2;
-        if (baton == 1) MS = M_MEASURE;		
-			break;
-			
-			case M_CAL2_T1 :
-				Update_Readout(1);
-			  LCD_Puts(0,1,"2T Kal: Tocka 1   ");
-			  if (updn == UP) MS = M_CAL2_EXIT;
-			  if (updn == DN) MS = M_CAL2_T2;
-			  if (baton == 1) DoCal(2,1);
-			break;
-
-			case M_CAL2_T2 :
-				Update_Readout(1);
-			  LCD_Puts(0,1,"2T Kal: Tocka 2   ");
-			  if (updn == UP) MS = M_CAL2_T1;
-			  if (updn == DN) MS = M_CAL2_EXIT;
-			  if (baton == 1) DoCal(2,2);
-			break;
-
-			case M_CAL2_EXIT :
-				Update_Readout(1);
-			  LCD_Puts(0,1,"2T Kal: Izhod     ");
-			  if (updn == UP) MS = M_CAL2_T2;
-			  if (updn == DN) MS = M_CAL2_T1;
-			  if (baton == 1) MS = M_MENU_CAL2;
-			break;
-
-			case M_CAL3_T1 :
-				Update_Readout(1);
-			  LCD_Puts(0,1,"3T Kal: Tocka 1   ");
-			  if (updn == UP) MS = M_CAL3_EXIT;
-			  if (updn == DN) MS = M_CAL3_T2;
-			  if (baton == 1) DoCal(3,1);
-			break;
-			
-			case M_CAL3_T2 :
-				Update_Readout(1);
-			  LCD_Puts(0,1,"3T Kal: Tocka 2   ");
-			  if (updn == UP) MS = M_CAL3_T1;
-			  if (updn == DN) MS = M_CAL3_T3;
-			  if (baton == 1) DoCal(3,2);
-			break;
-			
-			case M_CAL3_T3 :
-				Update_Readout(1);
-			  LCD_Puts(0,1,"3T Kal: Tocka 3   ");
-			  if (updn == UP) MS = M_CAL3_T2;
-			  if (updn == DN) MS = M_CAL3_EXIT;
-			  if (baton == 1) DoCal(3,3);
-			break;
-			
-			case M_CAL3_EXIT :
-				Update_Readout(1);
-			  LCD_Puts(0,1,"3T Kal: Izhod     ");
-			  if (updn == UP) MS = M_CAL3_T3;
-			  if (updn == DN) MS = M_CAL3_T1;
-			  if (baton == 1) MS = M_MENU_CAL3;
-			break;
-			
-		}
+		// handle encoder signals, redraw on the display job in between
+		ev = Menu_WaitEvent(osWaitForever);
+		Rt_Start(RT_JOB_UI, ev ? Tb_Us() : Sched_Release(SCHED_DISPLAY));
 		
-		baton = 0;
-		updn = 0;
+		Temp_Update();
 		
-    osThreadYield ();                                           // suspend thread
+		ms = Menu_Dispatch(M_Menu, MS, ev);
+		if (ev) TRACE_EVT(TRC_MENU_EVENT, ev);
+		if (ms != MS) TRACE_EVT(TRC_MENU_STATE, ms);
+		MS = ms;
+		Menu_Render(M_Menu, MS);
+		if (ev) TRACE_EVT(TRC_LCD_DONE, MS);
+		Rt_End(RT_JOB_UI);
   }
 }
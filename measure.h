@@ -0,0 +1,31 @@
+/**
+ * @file     measure.h
+ * @brief    Main measurement thread Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note
+ *
+ */
+
+#ifndef ___MEASURE_H_
+#define ___MEASURE_H_
+
+#include <stdint.h>
+
+/** \brief Splash screen poll for the first settled readout, ms */
+#define M_BOOT_POLL_MS			10
+
+/** \brief Deadline of a redraw, from the wakeup, ms */
+#define M_UI_DEADLINE_MS		50
+
+/** \brief Effective resolution, 0.001 pH, up to which the readout shows a
+ *         third decimal; it drops back at twice that */
+#define M_RES_3DEC					1
+
+int Init_Measure_Thread (void);
+uint16_t M_pH(uint32_t adc);
+uint16_t M_Resolution(uint32_t adc);
+uint32_t M_BootTime(void);
+
+#endif
@@ -0,0 +1,137 @@
+/**
+  ******************************************************************************
+  * @file    menu.c
+  * @author  e.pavlin.si
+  * @brief   Table driven menu engine
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  */
+
+#include "cmsis_os.h"                   // CMSIS RTOS header file
+#include "lcd.h"
+#include "encoder.h"
+#include "menu.h"
+#include "fmt.h"
+#include "trace.h"
+#include "cpuload.h"
+
+
+/**
+  * Follow transition of item 'state' for pending events.
+  * Button has priority over rotation. Returns new state.
+  */
+uint8_t Menu_Dispatch(const menu_item_t *menu, uint8_t state, uint32_t events)
+{
+	const menu_item_t *m = &menu[state];
+	uint8_t next = MENU_STAY;
+
+	if (events & MENU_EV_SELECT)
+	{
+		if (m->action) m->action(m->arg);
+		next = m->sel;
+	}
+	else if (events & MENU_EV_UP)
+	{
+		next = m->up;
+	}
+	else if (events & MENU_EV_DN)
+	{
+		next = m->dn;
+	}
+
+	return (next == MENU_STAY) ? state : next;
+}
+
+
+/**
+  * Draw item 'state'
+  */
+void Menu_Render(const menu_item_t *menu, uint8_t state)
+{
+	const menu_item_t *m = &menu[state];
+	char str[17], *e = str + 16;
+
+	if (m->render) m->render();
+	if (m->label)
+	{
+		Fmt_Fill(str, Fmt_Str(str, e, m->label, 0), 16);
+		LCD_Puts(0,1,str);
+	}
+}
+
+
+/**
+  * Collect all pending encoder signals with one call, waiting up to
+  * millisec. Returns MENU_EV_xxx bits, 0 on timeout or on the redraw
+  * signal of the display job (sched.h). The menu runs in Measure_Thread;
+  * the wait is its idle time for cpuload.
+  */
+uint32_t Menu_WaitEvent(uint32_t millisec)
+{
+	osEvent evt;
+
+	Load_Block(LOAD_MEASURE);
+	evt = osSignalWait (0, millisec);
+	Load_Run(LOAD_MEASURE);
+	if (evt.status == osEventSignal)
+	{
+		return (uint32_t)evt.value.signals & (ENCODER_BUTTON | ENCODER_UP | ENCODER_DN);
+	}
+	return 0;
+}
+
+
+/**
+  * Edit value 0..max with encoder until button is pressed.
+  * show() is called to draw the current value.
+  * With wrap set, value rolls over (used for yes/no choices).
+  */
+void Menu_Edit(uint16_t *val, uint16_t max, uint8_t wrap, void (*show)(uint16_t val))
+{
+	uint32_t ev = 0;
+
+	while (1)
+	{
+		show(*val);
+		if (ev) TRACE_EVT(TRC_LCD_DONE, *val);
+		ev = Menu_WaitEvent(osWaitForever);
+		if (ev & MENU_EV_SELECT) break;
+
+		if (ev & MENU_EV_UP)
+		{
+			if (*val < max) (*val)++; else if (wrap) *val = 0;
+		}
+		if (ev & MENU_EV_DN)
+		{
+			if (*val > 0) (*val)--; else if (wrap) *val = max;
+		}
+	}
+}
@@ -0,0 +1,49 @@
+/**
+ * @file     menu.h
+ * @brief    Table driven menu engine Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Menu is a const table of items, indexed by state. The engine
+ *           only follows transitions and calls actions, so new screens are
+ *           added to the table without touching the thread loop.
+ *
+ */
+
+#ifndef ___MENU_H_
+#define ___MENU_H_
+
+#include <stdint.h>
+
+/** \brief Transition target: stay in the current item */
+#define MENU_STAY		0xFF
+
+/** \brief Events, same bits as encoder signals */
+#define MENU_EV_SELECT	0x00000001
+#define MENU_EV_UP			0x00000002
+#define MENU_EV_DN			0x00000004
+
+
+typedef void (*menu_action_t)(uint8_t arg);
+typedef void (*menu_render_t)(void);
+
+
+/** \brief One menu item (screen) */
+typedef struct
+{
+	menu_render_t render;			/*!< draws first line (and second if label is NULL) */
+	const char *label;				/*!< second line text or NULL */
+	uint8_t up;								/*!< next item on UP event */
+	uint8_t dn;								/*!< next item on DN event */
+	uint8_t sel;							/*!< next item on button, after action */
+	menu_action_t action;			/*!< called on button or NULL */
+	uint8_t arg;							/*!< argument for action */
+} menu_item_t;
+
+
+uint8_t Menu_Dispatch(const menu_item_t *menu, uint8_t state, uint32_t events);
+void Menu_Render(const menu_item_t *menu, uint8_t state);
+uint32_t Menu_WaitEvent(uint32_t millisec);
+void Menu_Edit(uint16_t *val, uint16_t max, uint8_t wrap, void (*show)(uint16_t val));
+
+#endif
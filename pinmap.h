@@ -0,0 +1,108 @@
+/**
+ * @file     pinmap.h
+ * @brief    Board pin map Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Every pin of the board, once. The *PORTn and *PINn numbers
+ *           feed the pin maps (see gpio_cfg.h) and the port and bit
+ *           macros the drivers use.
+ *
+ */
+
+#ifndef ___PINMAP_H_
+#define ___PINMAP_H_
+
+#include "gpio_cfg.h"
+
+/*----------------------------------------------------------------------------
+ *  LCD, HD44780 4-bit bus
+ */
+
+#define LCD_RSPORTn				GPIO_PB
+#define LCD_RSPINn				1
+
+#define LCD_EPORTn				GPIO_PA
+#define LCD_EPINn					4
+
+#define LCD_D4PORTn				GPIO_PA
+#define LCD_D4PINn				3
+
+#define LCD_D5PORTn				GPIO_PA
+#define LCD_D5PINn				2
+
+#define LCD_D6PORTn				GPIO_PA
+#define LCD_D6PINn				1
+
+#define LCD_D7PORTn				GPIO_PA
+#define LCD_D7PINn				0
+
+#define LCD_PINMAP(X, p) \
+	X(p, LCD_RSPORTn, LCD_RSPINn, GPIO_MODE_OUT, GPIO_PULL_NONE) \
+	X(p, LCD_EPORTn,  LCD_EPINn,  GPIO_MODE_OUT, GPIO_PULL_NONE) \
+	X(p, LCD_D4PORTn, LCD_D4PINn, GPIO_MODE_OUT, GPIO_PULL_NONE) \
+	X(p, LCD_D5PORTn, LCD_D5PINn, GPIO_MODE_OUT, GPIO_PULL_NONE) \
+	X(p, LCD_D6PORTn, LCD_D6PINn, GPIO_MODE_OUT, GPIO_PULL_NONE) \
+	X(p, LCD_D7PORTn, LCD_D7PINn, GPIO_MODE_OUT, GPIO_PULL_NONE)
+
+/*----------------------------------------------------------------------------
+ *  AD7715, bit-banged SPI
+ */
+
+#define AD7715_CLKPORTn		GPIO_PA
+#define AD7715_CLKPINn		5
+
+#define AD7715_MOSIPORTn	GPIO_PA
+#define AD7715_MOSIPINn		7
+
+#define AD7715_MISOPORTn	GPIO_PA
+#define AD7715_MISOPINn		6
+
+#define AD7715_CSPORTn		GPIO_PF
+#define AD7715_CSPINn			1
+
+#define AD7715_PINMAP(X, p) \
+	X(p, AD7715_CLKPORTn,  AD7715_CLKPINn,  GPIO_MODE_OUT, GPIO_PULL_NONE) \
+	X(p, AD7715_MOSIPORTn, AD7715_MOSIPINn, GPIO_MODE_OUT, GPIO_PULL_NONE) \
+	X(p, AD7715_CSPORTn,   AD7715_CSPINn,   GPIO_MODE_OUT, GPIO_PULL_NONE) \
+	X(p, AD7715_MISOPORTn, AD7715_MISOPINn, GPIO_MODE_IN,  GPIO_PULL_UP)
+
+/*----------------------------------------------------------------------------
+ *  Encoder; A and K trigger EXTI10 and EXTI0, see Encoder_Init()
+ */
+
+#define ENCODER_APORTn		GPIO_PA
+#define ENCODER_APINn			10
+
+#define ENCODER_BPORTn		GPIO_PA
+#define ENCODER_BPINn			9
+
+#define ENCODER_KPORTn		GPIO_PF
+#define ENCODER_KPINn			0
+
+#define ENCODER_PINMAP(X, p) \
+	X(p, ENCODER_APORTn, ENCODER_APINn, GPIO_MODE_IN, GPIO_PULL_UP) \
+	X(p, ENCODER_BPORTn, ENCODER_BPINn, GPIO_MODE_IN, GPIO_PULL_UP) \
+	X(p, ENCODER_KPORTn, ENCODER_KPINn, GPIO_MODE_IN, GPIO_PULL_UP)
+
+/*----------------------------------------------------------------------------
+ *  Temperature, PT1000 divider; PB0 is ADC_IN8, see Temp_Init()
+ */
+
+#define TEMP_PTPORTn			GPIO_PB
+#define TEMP_PTPINn				0
+
+#define TEMP_PINMAP(X, p) \
+	X(p, TEMP_PTPORTn, TEMP_PTPINn, GPIO_MODE_AN, GPIO_PULL_NONE)
+
+/*----------------------------------------------------------------------------
+ *  All pins, checked for conflicts in gpio_cfg.c
+ */
+
+#define BOARD_PINMAP(X, p) \
+	LCD_PINMAP(X, p) \
+	AD7715_PINMAP(X, p) \
+	ENCODER_PINMAP(X, p) \
+	TEMP_PINMAP(X, p)
+
+#endif
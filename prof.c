@@ -0,0 +1,140 @@
+/**
+  ******************************************************************************
+  * @file    prof.c
+  * @author  e.pavlin.si
+  * @brief   Cycle profiling of code regions
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * osKernelSysTick() wraps after 2^32 clocks (89 s at 48 MHz); unsigned
+  * subtraction gives the right result for any shorter region. Without
+  * PROFILE this file is empty.
+  *
+  */
+
+#include "prof.h"
+
+#ifdef PROFILE
+
+#include "fmt.h"
+
+/** Region statistics, for the debugger */
+prof_region_t Prof[PROF_NREGIONS];
+
+/** Local variables */
+static uint32_t prof_bias;						// cost of one counter read
+
+static const char * const prof_names[PROF_NREGIONS] =
+{
+	"ad7715 block",
+	"M_pH",
+	"readout",
+	"LCD_Puts"
+};
+
+
+/**
+  * Clear all regions
+  */
+void Prof_Reset(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < PROF_NREGIONS; i++)
+	{
+		Prof[i].count = 0;
+		Prof[i].min = 0xFFFFFFFF;
+		Prof[i].max = 0;
+		Prof[i].sum = 0;
+	}
+}
+
+
+/**
+  * Measure the cost of an empty region and clear all regions.
+  * Call after osKernelStart(), when SysTick runs.
+  */
+void Prof_Init(void)
+{
+	uint32_t t0, d;
+	uint8_t i;
+
+	prof_bias = 0xFFFFFFFF;
+	for (i = 0; i < 8; i++)
+	{
+		t0 = osKernelSysTick();
+		d = osKernelSysTick() - t0;
+		if (d < prof_bias) prof_bias = d;
+	}
+	Prof_Reset();
+}
+
+
+/**
+  * End of a region
+  */
+void Prof_Stop(uint8_t id)
+{
+	prof_region_t *r = &Prof[id];
+	uint32_t d = osKernelSysTick() - r->t0;
+
+	d = (d > prof_bias) ? d - prof_bias : 0;
+	r->count++;
+	r->sum += d;
+	if (d < r->min) r->min = d;
+	if (d > r->max) r->max = d;
+}
+
+
+uint32_t Prof_Avg(uint8_t id)
+{
+	if (Prof[id].count == 0) return 0;
+	return (uint32_t)(Prof[id].sum / Prof[id].count);
+}
+
+
+/**
+  * "name count min avg max", clocks; dst holds PROF_LINE_LEN characters
+  */
+char *Prof_Line(char *dst, uint8_t id)
+{
+	char *p, *e = dst + PROF_LINE_LEN - 1;
+
+	p = Fmt_Str(dst, e, prof_names[id], 14);
+	p = Fmt_Uint(p, e, Prof[id].count, 11, ' ');
+	p = Fmt_Uint(p, e, Prof[id].count ? Prof[id].min : 0, 11, ' ');
+	p = Fmt_Uint(p, e, Prof_Avg(id), 11, ' ');
+	p = Fmt_Uint(p, e, Prof[id].max, 11, ' ');
+	*p = 0;
+	return p;
+}
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file     prof.h
+ * @brief    Cycle profiling of code regions Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Cortex-M0 has no DWT cycle counter. Regions are timed with
+ *           osKernelSysTick(), the RTX tick count extended by SysTick VAL,
+ *           which counts core clocks. Each region keeps count, min, max
+ *           and sum. The cost of reading the counter is measured in
+ *           Prof_Init() and subtracted.
+ *
+ *           PROF_START/PROF_STOP compile to nothing unless PROFILE is
+ *           defined (C/C++ Defines of the target). Results are in Prof[]
+ *           for the debugger watch window, and Prof_Line() formats one
+ *           region for a text dump.
+ *
+ *           A region must not be entered again before it is stopped, so
+ *           each one should be used by one thread only. Not in interrupt
+ *           handlers either: osKernelSysTick() returns 0 in handler mode.
+ *
+ */
+
+#ifndef ___PROF_H_
+#define ___PROF_H_
+
+#include <stdint.h>
+#include "cmsis_os.h"
+
+/** \brief Profiled regions */
+#define PROF_AD7715_SAMPLE	0		/*!< block of conversions: filter, statistics, titration */
+#define PROF_M_PH						1		/*!< M_pH() */
+#define PROF_READOUT				2		/*!< Update_Readout() */
+#define PROF_LCD_PUTS				3		/*!< LCD_Puts() */
+#define PROF_NREGIONS				4
+
+/** \brief Length of a Prof_Line() result, with terminating zero */
+#define PROF_LINE_LEN				64
+
+/** \brief Statistics of one region, in core clocks */
+typedef struct
+{
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t t0;							/*!< start of the current pass */
+} prof_region_t;
+
+
+#ifdef PROFILE
+
+extern prof_region_t Prof[PROF_NREGIONS];
+
+void Prof_Init(void);
+void Prof_Reset(void);
+void Prof_Stop(uint8_t id);
+uint32_t Prof_Avg(uint8_t id);
+char *Prof_Line(char *dst, uint8_t id);
+
+#define PROF_INIT()					Prof_Init()
+#define PROF_START(id)			(Prof[id].t0 = osKernelSysTick())
+#define PROF_STOP(id)				Prof_Stop(id)
+
+#else
+
+#define PROF_INIT()					((void)0)
+#define PROF_START(id)			((void)0)
+#define PROF_STOP(id)				((void)0)
+
+#endif
+
+#endif
@@ -33,6 +33,10 @@
  *---------------------------------------------------------------------------*/
  
 #include "cmsis_os.h"
+#include "stkmon.h"
+#include "timebase.h"
+#include "cpuload.h"
+#include "stm32f0xx.h"
  
 
 /*----------------------------------------------------------------------------
@@ -62,21 +66,21 @@
 //   <i> Defines stack size for main thread.
 //   <i> Default: 200
 #ifndef OS_MAINSTKSIZE
- #define OS_MAINSTKSIZE 50      // this stack size value is in words
+ #define OS_MAINSTKSIZE 80      // this stack size value is in words
 #endif
  
 //   <o>Number of threads with user-provided stack size <0-250>
 //   <i> Defines the number of threads with user-provided stack size.
 //   <i> Default: 0
 #ifndef OS_PRIVCNT
- #define OS_PRIVCNT     1
+ #define OS_PRIVCNT     2
 #endif
  
 //   <o>Total stack size [bytes] for threads with user-provided stack size <0-1048576:8><#/4>
 //   <i> Defines the combined stack size for threads with user-provided stack size.
 //   <i> Default: 0
 #ifndef OS_PRIVSTKSIZE
- #define OS_PRIVSTKSIZE 256       // this stack size value is in words
+ #define OS_PRIVSTKSIZE 316       // this stack size value is in words
 #endif
  
 //   <q>Stack overflow checking
@@ -90,7 +94,7 @@
 //   <i> Initialize thread stack with watermark pattern for analyzing stack usage (current/maximum) in System and Thread Viewer.
 //   <i> Enabling this option increases significantly the execution time of osThreadCreate.
 #ifndef OS_STKINIT
-#define OS_STKINIT      0
+#define OS_STKINIT      1
 #endif
  
 //   <o>Processor mode for thread execution 
@@ -117,7 +121,10 @@
 //   <i> When the Cortex-M SysTick timer is used, the input clock 
 //   <i> is on most systems identical with the core clock.
 #ifndef OS_CLOCK
- #define OS_CLOCK       12000000
+ #define OS_CLOCK       48000000
+#endif
+#if (OS_CLOCK != TB_CORE_HZ)
+ #error "OS_CLOCK must be the core clock, TB_CORE_HZ in timebase.h"
 #endif
  
 //   <o>RTX Timer tick interval value [us] <1-1000000>
@@ -137,8 +144,9 @@
 // ===============================
 //
 // <i> Enables Round-Robin Thread switching.
+// <i> Off: every thread has its own priority, see rtmon.h.
 #ifndef OS_ROBIN
- #define OS_ROBIN       1
+ #define OS_ROBIN       0
 #endif
  
 //   <o>Round-Robin Timeout [ticks] <1-1000>
@@ -172,7 +180,7 @@
 //   <i> Defines stack size for Timer thread.
 //   <i> Default: 200
 #ifndef OS_TIMERSTKSZ
- #define OS_TIMERSTKSZ  50     // this stack size value is in words
+ #define OS_TIMERSTKSZ  76     // this stack size value is in words
 #endif
  
 //   <o>Timer Callback Queue size <1-32>
@@ -221,11 +229,32 @@
  
 /*--------------------------- os_idle_demon ---------------------------------*/
 
+/* Scheduler suspend and resume for tickless idle (rt_System.c) */
+extern uint32_t os_suspend (void);
+extern void     os_resume  (uint32_t sleep_time);
+
 /// \brief The idle demon is running when no other thread is ready to run
+/// \note  Tickless: the scheduler is suspended, SysTick stops interrupting
+///        and the core sleeps in WFI until the next timeout (TIM3 compare,
+///        Tb_WakeAt) or any other interrupt, e.g. the encoder. The time
+///        slept is given back to RTX in whole ticks; the rest is carried.
+///        STOP mode is not used: it stops TIM3 together with the PLL.
 void os_idle_demon (void) {
+  uint32_t sleep, t0, dt, rem = 0;
  
+  Stk_Register(STK_IDLE, 0);
   for (;;) {
-    /* HERE: include optional user code to be executed when no thread runs.*/
+    sleep = os_suspend();                   // ticks to the next timeout
+    t0 = Tb_Us();
+    if (sleep && Tb_WakeAt(t0 + sleep * OS_TICK - rem)) {
+      __disable_irq();
+      __WFI();                              // wakes on a pending interrupt
+      Load_Idle(Tb_Us() - t0);
+      __enable_irq();
+    }
+    dt = Tb_Us() - t0 + rem;
+    rem = dt % OS_TICK;
+    os_resume(dt / OS_TICK);
   }
 }
  
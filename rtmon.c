@@ -0,0 +1,115 @@
+/**
+  ******************************************************************************
+  * @file    rtmon.c
+  * @author  e.pavlin.si
+  * @brief   Real-time job monitor
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * Each job is started and ended by one thread, so the fields need no
+  * locking; the debugger may see a run half accounted.
+  *
+  */
+
+#include "rtmon.h"
+#include "timebase.h"
+#include "fmt.h"
+
+/** Jobs, for the debugger */
+rt_job_t RtJob[RT_NJOBS];
+
+static const char * const rt_names[RT_NJOBS] =
+{
+	"acquisition",
+	"control",
+	"ui",
+	"log",
+	"diag",
+	"trend"
+};
+
+
+/**
+  * Period and deadline of a job, again when they change
+  */
+void Rt_Declare(uint8_t id, uint32_t period_us, uint32_t deadline_us)
+{
+	RtJob[id].period = period_us;
+	RtJob[id].deadline = deadline_us;
+}
+
+
+/**
+  * A run begins; release is the Tb_Us() it became due
+  */
+void Rt_Start(uint8_t id, uint32_t release)
+{
+	RtJob[id].release = release;
+	RtJob[id].start = Tb_Us();
+}
+
+
+/**
+  * The run is done: response and execution time, worst cases, deadline
+  */
+void Rt_End(uint8_t id)
+{
+	rt_job_t *j = &RtJob[id];
+	uint32_t now = Tb_Us();
+	uint32_t r = now - j->release;
+
+	j->exec = now - j->start;
+	if (j->exec > j->wcet) j->wcet = j->exec;
+	j->last = r;
+	if (r > j->wcrt) j->wcrt = r;
+	if (r > j->deadline) j->misses++;
+	j->runs++;
+}
+
+
+/**
+  * "name period deadline worst-response worst-execution misses runs",
+  * times in ms; dst holds RT_LINE_LEN characters
+  */
+char *Rt_Line(char *dst, uint8_t id)
+{
+	char *p, *e = dst + RT_LINE_LEN - 1;
+
+	p = Fmt_Str(dst, e, rt_names[id], 12);
+	p = Fmt_Fixed(p, e, (int32_t)(RtJob[id].period / 100), 1, 8);
+	p = Fmt_Fixed(p, e, (int32_t)(RtJob[id].deadline / 100), 1, 8);
+	p = Fmt_Fixed(p, e, (int32_t)(RtJob[id].wcrt / 100), 1, 8);
+	p = Fmt_Fixed(p, e, (int32_t)(RtJob[id].wcet / 10), 2, 8);
+	p = Fmt_Uint(p, e, RtJob[id].misses, 7, ' ');
+	p = Fmt_Uint(p, e, RtJob[id].runs, 8, ' ');
+	*p = 0;
+	return p;
+}
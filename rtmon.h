@@ -0,0 +1,75 @@
+/**
+ * @file     rtmon.h
+ * @brief    Priority plan and deadline monitor Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Threads run at fixed, distinct priorities, highest first:
+ *
+ *             RT_PRIO_ACQ   AD7715_Thread, conversion blocks
+ *             RT_PRIO_CTRL  control loops; titration runs in the
+ *                           acquisition thread, the level is reserved
+ *             RT_PRIO_UI    Measure_Thread, encoder and display
+ *             RT_PRIO_LOG   main(), utilization window
+ *
+ *           No two threads share a level, so round robin is off
+ *           (OS_ROBIN 0 in RTX_Conf_CM.c).
+ *
+ *           Each periodic job declares its period and deadline with
+ *           Rt_Declare(), and brackets every run with Rt_Start() and
+ *           Rt_End(). The response time runs from the release, given to
+ *           Rt_Start(), to Rt_End(); a response over the deadline counts
+ *           as a miss. The execution time runs from the Rt_Start() call,
+ *           and includes preemption by higher priorities. Results are in
+ *           RtJob[] for the debugger watch window, and Rt_Line() formats
+ *           one job.
+ *
+ */
+
+#ifndef ___RTMON_H_
+#define ___RTMON_H_
+
+#include <stdint.h>
+#include "cmsis_os.h"                   // CMSIS RTOS header file
+
+/** \brief Thread priorities */
+#define RT_PRIO_ACQ					osPriorityAboveNormal
+#define RT_PRIO_CTRL				osPriorityNormal
+#define RT_PRIO_UI					osPriorityBelowNormal
+#define RT_PRIO_LOG					osPriorityLow
+
+/** \brief Monitored jobs */
+#define RT_JOB_ACQ					0			/*!< a block of conversions, from the last one read */
+#define RT_JOB_CTRL					1			/*!< a titration point, from its last conversion */
+#define RT_JOB_UI						2			/*!< a menu event, from the wakeup, or a redraw */
+#define RT_JOB_LOG					3			/*!< Load_Update() */
+#define RT_JOB_DIAG					4			/*!< stack scan */
+#define RT_JOB_TREND				5			/*!< trend sample */
+#define RT_NJOBS						6
+
+/** \brief Length of an Rt_Line() result, with terminating zero */
+#define RT_LINE_LEN					64
+
+/** \brief One job, times in us */
+typedef struct
+{
+	uint32_t period;				/*!< declared */
+	uint32_t deadline;			/*!< declared, from the release */
+	uint32_t release;				/*!< of the run in progress, Tb_Us() */
+	uint32_t start;					/*!< of the run in progress, Tb_Us() */
+	uint32_t last;					/*!< response time of the last run */
+	uint32_t wcrt;					/*!< worst response time */
+	uint32_t exec;					/*!< execution time of the last run */
+	uint32_t wcet;					/*!< worst execution time */
+	uint32_t runs;
+	uint16_t misses;				/*!< runs over the deadline */
+} rt_job_t;
+
+extern rt_job_t RtJob[RT_NJOBS];
+
+void Rt_Declare(uint8_t id, uint32_t period_us, uint32_t deadline_us);
+void Rt_Start(uint8_t id, uint32_t release);
+void Rt_End(uint8_t id);
+char *Rt_Line(char *dst, uint8_t id);
+
+#endif
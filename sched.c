@@ -0,0 +1,118 @@
+/**
+  ******************************************************************************
+  * @file    sched.c
+  * @author  e.pavlin.si
+  * @brief   Periodic job scheduler
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * The callback runs in the RTX timer thread, above all others. Thread
+  * ids are written once by Sched_Join() and release times by the
+  * callback only; 32 bit stores are atomic on the M0.
+  *
+  */
+
+#include "sched.h"
+#include "timebase.h"
+#include "cpuload.h"
+
+/** Jobs, for the debugger */
+sched_job_t SchedJob[SCHED_NJOBS] =
+{
+	{ 2, 0, 0, 0 },                                   // SCHED_DISPLAY
+	{ LOAD_WINDOW_MS / SCHED_TICK_MS, 1, 0, 0 },      // SCHED_LOG
+	{ 100, 3, 0, 0 },                                 // SCHED_DIAG
+	{ 1000 / SCHED_TICK_MS, 5, 0, 0 },                // SCHED_TREND
+};
+
+static uint32_t sched_tick;
+
+static void Sched_Tick(void const *argument);
+osTimerDef (Sched_Timer, Sched_Tick);
+
+
+/**
+  * Release the jobs due on this tick
+  */
+static void Sched_Tick(void const *argument)
+{
+	sched_job_t *j;
+	uint8_t i;
+
+	Load_Run(LOAD_TIMER);
+	for (i = 0; i < SCHED_NJOBS; i++)
+	{
+		j = &SchedJob[i];
+		if ((j->tid == 0) || ((sched_tick % j->period) != j->phase)) continue;
+		j->release = Tb_Us();
+		osSignalSet(j->tid, SCHED_SIG(i));
+	}
+	sched_tick++;
+	Load_Block(LOAD_TIMER);
+}
+
+
+/**
+  * Start the tick; after osKernelInitialize()
+  */
+void Sched_Init(void)
+{
+	osTimerId id = osTimerCreate(osTimer(Sched_Timer), osTimerPeriodic, NULL);
+
+	if (id) osTimerStart(id, SCHED_TICK_MS);
+}
+
+
+/**
+  * The calling thread runs job id from now on
+  */
+void Sched_Join(uint8_t id)
+{
+	SchedJob[id].tid = osThreadGetId();
+}
+
+
+/**
+  * Tb_Us() of the last release of job id
+  */
+uint32_t Sched_Release(uint8_t id)
+{
+	return SchedJob[id].release;
+}
+
+
+/**
+  * Period of job id, us
+  */
+uint32_t Sched_PeriodUs(uint8_t id)
+{
+	return SchedJob[id].period * SCHED_TICK_MS * 1000UL;
+}
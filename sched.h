@@ -0,0 +1,61 @@
+/**
+ * @file     sched.h
+ * @brief    Periodic job scheduler Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     One RTX periodic timer ticks every SCHED_TICK_MS. On each tick
+ *           the callback releases the jobs that are due: it notes the
+ *           time and sets the job's signal on the thread that joined it
+ *           with Sched_Join(). The job then runs in that thread, at that
+ *           thread's priority (rtmon.h); the timer thread does no more
+ *           than set signals.
+ *
+ *           A job is due on ticks where tick % period == phase. The
+ *           phases are chosen so no two jobs share a tick:
+ *
+ *             display  200 ms, phase 0   Measure_Thread
+ *             log        1 s,  phase 1   main()
+ *             diag      10 s,  phase 3   main()
+ *             trend      1 s,  phase 5   main()
+ *
+ *           Execution and response times are kept by rtmon.c.
+ *
+ */
+
+#ifndef ___SCHED_H_
+#define ___SCHED_H_
+
+#include <stdint.h>
+#include "cmsis_os.h"                   // CMSIS RTOS header file
+
+/** \brief Scheduler tick, ms */
+#define SCHED_TICK_MS				100
+
+/** \brief Jobs */
+#define SCHED_DISPLAY				0			/*!< redraw without encoder events */
+#define SCHED_LOG						1			/*!< Load_Update() */
+#define SCHED_DIAG					2			/*!< stack scan */
+#define SCHED_TREND					3			/*!< pH sample of the trend graph */
+#define SCHED_NJOBS					4
+
+/** \brief Thread signal of a job, above the encoder signals */
+#define SCHED_SIG(id)				(0x0100 << (id))
+
+/** \brief One job */
+typedef struct
+{
+	uint16_t period;				/*!< ticks */
+	uint16_t phase;					/*!< ticks, < period */
+	osThreadId tid;					/*!< thread that runs it, 0 until Sched_Join() */
+	uint32_t release;				/*!< Tb_Us() of the last release */
+} sched_job_t;
+
+extern sched_job_t SchedJob[SCHED_NJOBS];
+
+void Sched_Init(void);
+void Sched_Join(uint8_t id);
+uint32_t Sched_Release(uint8_t id);
+uint32_t Sched_PeriodUs(uint8_t id);
+
+#endif
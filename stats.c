@@ -0,0 +1,195 @@
+/**
+  ******************************************************************************
+  * @file    stats.c
+  * @author  e.pavlin.si
+  * @brief   Windowed statistics
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * The window keeps the sum of its conversions and the sum of their
+  * squares. A conversion is added when it comes in and subtracted when it
+  * leaves, both in exact integers, so the sums do not drift the way a
+  * running mean in fixed point would. Mean and variance are taken from
+  * them only when read: var = (n * s2 - s1^2) / (n * (n - 1)).
+  *
+  * Minimum and maximum are the fronts of two monotonic deques of sample
+  * numbers. A new conversion first removes every entry from the back that
+  * it beats, so the values stay ordered from the front, and the front
+  * leaves with its conversion. Each conversion enters and leaves a deque
+  * once.
+  *
+  * Sample numbers are 8 bits. The ring holds the last STATS_MAX_N
+  * conversions at sample number & STATS_MASK, and the deques use the same
+  * indexing.
+  *
+  * Stats_Sample() makes Stats_Seq odd while it updates. A reader copies
+  * the window between two equal, even values of it.
+  *
+  */
+
+#include "stm32f0xx.h"                  // Device header
+#include "stats.h"
+
+#define STATS_MASK				(STATS_MAX_N - 1)
+
+#if (STATS_MAX_N > 128) || (STATS_MAX_N & STATS_MASK)
+#error "STATS_MAX_N must be a power of 2 up to 128"
+#endif
+
+/** Local variables */
+static uint16_t ring[STATS_MAX_N];                  // last conversions
+static uint8_t dq_min[STATS_MAX_N];                 // sample numbers, values rising from the front
+static uint8_t dq_max[STATS_MAX_N];                 // sample numbers, values falling from the front
+static uint8_t min_h, min_t, max_h, max_t;          // deque front and back, & STATS_MASK
+static uint8_t pos;                                 // number of the next sample
+static uint16_t win_n;                              // conversions in the window
+static uint16_t win_len = STATS_WIN(STATS_NWIN - 1);
+static uint32_t s1;                                 // sum of the window
+static uint64_t s2;                                 // sum of squares
+static volatile uint16_t req_len;                   // requested window, 0 if none
+static volatile uint32_t Stats_Seq;
+
+
+/**
+  * Start over with a window of len conversions, from the next one on
+  */
+void Stats_SetWindow(uint16_t len)
+{
+	if (len < 2) len = 2;
+	if (len > STATS_MAX_N) len = STATS_MAX_N;
+	req_len = len;
+}
+
+
+/**
+  * Add a conversion to the window; the oldest one leaves a full window
+  */
+void Stats_Sample(uint16_t rd)
+{
+	uint16_t old;
+	uint8_t k;
+
+	Stats_Seq++;
+	__DMB();
+
+	if (req_len)
+	{
+		win_len = req_len;
+		req_len = 0;
+		win_n = 0;
+		s1 = 0;
+		s2 = 0;
+		min_h = min_t = max_h = max_t = 0;
+	}
+
+	if (win_n == win_len)
+	{
+		k = (uint8_t)(pos - win_len);
+		old = ring[k & STATS_MASK];
+		s1 -= old;
+		s2 -= (uint32_t)old * old;
+		if (dq_min[min_h & STATS_MASK] == k) min_h++;
+		if (dq_max[max_h & STATS_MASK] == k) max_h++;
+	}
+	else win_n++;
+
+	ring[pos & STATS_MASK] = rd;
+	s1 += rd;
+	s2 += (uint32_t)rd * rd;
+
+	while ((min_t != min_h) && (ring[dq_min[(min_t - 1) & STATS_MASK] & STATS_MASK] >= rd)) min_t--;
+	dq_min[min_t++ & STATS_MASK] = pos;
+	while ((max_t != max_h) && (ring[dq_max[(max_t - 1) & STATS_MASK] & STATS_MASK] <= rd)) max_t--;
+	dq_max[max_t++ & STATS_MASK] = pos;
+	pos++;
+
+	__DMB();
+	Stats_Seq++;
+}
+
+
+static uint32_t Stats_Sqrt(uint32_t x)
+{
+	uint32_t r = 0, b = 1UL << 30;
+
+	while (b > x) b >>= 2;
+	while (b)
+	{
+		if (x >= r + b)
+		{
+			x -= r + b;
+			r = (r >> 1) + b;
+		}
+		else r >>= 1;
+		b >>= 2;
+	}
+	return r;
+}
+
+
+/**
+  * Statistics of the window. Only the copy retries, the arithmetic is
+  * done once after it.
+  */
+void Stats_Get(stats_result_t *r)
+{
+	uint32_t seq, sum;
+	uint64_t sq, v;
+
+	do
+	{
+		seq = Stats_Seq;
+		__DMB();
+		r->n = win_n;
+		r->len = win_len;
+		sum = s1;
+		sq = s2;
+		r->min = ring[dq_min[min_h & STATS_MASK] & STATS_MASK];
+		r->max = ring[dq_max[max_h & STATS_MASK] & STATS_MASK];
+		__DMB();
+	} while ((seq & 1) || (seq != Stats_Seq));
+
+	r->mean_q8 = 0;
+	r->sd_q8 = 0;
+	if (r->n == 0)
+	{
+		r->min = r->max = 0;
+		return;
+	}
+	r->mean_q8 = ((sum << 8) + r->n / 2) / r->n;
+	if (r->n > 1)
+	{
+		/* variance Q16, up to (n * s2 - s1^2) < 2^44 before the shift */
+		v = (((uint64_t)r->n * sq - (uint64_t)sum * sum) << 16) / ((uint32_t)r->n * (r->n - 1));
+		v = Stats_Sqrt((v > 0xFFFFFFFFUL) ? 0xFFFFFFFFUL : (uint32_t)v);
+		r->sd_q8 = (v > 0xFFFF) ? 0xFFFF : (uint16_t)v;
+	}
+}
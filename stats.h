@@ -0,0 +1,47 @@
+/**
+ * @file     stats.h
+ * @brief    Windowed statistics Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Mean, standard deviation, minimum and maximum of the last
+ *           conversions, over a window of STATS_WIN(i) of them.
+ *           AD7715_Thread feeds every conversion to Stats_Sample(), at a
+ *           cost that does not depend on the window length.
+ *
+ *           Stats_Get() takes no lock. It retries while a conversion comes
+ *           in, so it must not be called from a thread above
+ *           AD7715_Thread.
+ *
+ */
+
+#ifndef ___STATS_H_
+#define ___STATS_H_
+
+#include <stdint.h>
+
+/** \brief Conversions kept, the longest window; a power of 2 up to 128 */
+#ifndef STATS_MAX_N
+#define STATS_MAX_N					128
+#endif
+
+/** \brief Window lengths selectable from the menu, conversions */
+#define STATS_NWIN					4
+#define STATS_WIN(i)				((uint16_t)(STATS_MAX_N >> (STATS_NWIN - 1 - (i))))
+
+/** \brief Statistics of the window */
+typedef struct
+{
+	uint32_t mean_q8;				/*!< codes Q16.8 */
+	uint16_t sd_q8;					/*!< standard deviation, codes Q8.8 */
+	uint16_t min;						/*!< codes */
+	uint16_t max;
+	uint16_t n;							/*!< conversions in the window so far */
+	uint16_t len;						/*!< window length */
+} stats_result_t;
+
+void Stats_SetWindow(uint16_t len);
+void Stats_Sample(uint16_t rd);
+void Stats_Get(stats_result_t *r);
+
+#endif
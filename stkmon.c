@@ -0,0 +1,131 @@
+/**
+  ******************************************************************************
+  * @file    stkmon.c
+  * @author  e.pavlin.si
+  * @brief   Thread stack high-water monitor
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * The fill pattern and the overflow word are written by rt_init_stack()
+  * in RTX. os_stackinfo holds the default stack size in its low half.
+  *
+  */
+
+#include "stm32f0xx.h"                  // Device header
+#include "stkmon.h"
+#include "fmt.h"
+
+#define STK_MAGIC_WORD			0xE25A2EA5UL
+#define STK_MAGIC_PATTERN		0xCCCCCCCCUL
+
+/** RTX stack configuration (RTX_CM_lib.h) */
+extern const uint32_t os_stackinfo;
+
+/** Thread stacks, for the debugger */
+stk_info_t Stk[STK_NTHREADS];
+
+static const char * const stk_names[STK_NTHREADS] =
+{
+	"main",
+	"AD7715_Thread",
+	"Measure_Thread",
+	"os_idle_demon"
+};
+
+
+/**
+  * Find the stack of the calling thread. size in bytes as given to
+  * osThreadDef(), 0 for the default size.
+  */
+void Stk_Register(uint8_t id, uint16_t size)
+{
+	uint32_t here;
+	const uint32_t *p = &here;
+	const uint32_t *lim;
+
+	if (size == 0) size = (uint16_t)os_stackinfo;
+	lim = p - size / 4;
+	if ((uintptr_t)lim < SRAM_BASE) lim = (const uint32_t *)SRAM_BASE;
+
+	while ((p > lim) && (*p != STK_MAGIC_WORD)) p--;
+	Stk[id].base = (*p == STK_MAGIC_WORD) ? p : 0;
+	Stk[id].size = size;
+	Stk_Scan(id);
+}
+
+
+/**
+  * Bytes of the stack never written since the thread started
+  */
+uint16_t Stk_Scan(uint8_t id)
+{
+	const uint32_t *p = Stk[id].base;
+	const uint32_t *end;
+
+	if (p == 0) return 0;
+	end = p + Stk[id].size / 4;
+	p++;
+	while ((p < end) && (*p == STK_MAGIC_PATTERN)) p++;
+	Stk[id].free = (uint16_t)((p - Stk[id].base - 1) * 4);
+	return Stk[id].free;
+}
+
+
+/**
+  * High-water mark in bytes, 0 if the stack was not found
+  */
+uint16_t Stk_Used(uint8_t id)
+{
+	if (Stk[id].base == 0) return 0;
+	return (uint16_t)(Stk[id].size - 4 - Stk_Scan(id));
+}
+
+
+/**
+  * "name size used free", bytes; dst holds STK_LINE_LEN characters
+  */
+char *Stk_Line(char *dst, uint8_t id)
+{
+	char *p, *e = dst + STK_LINE_LEN - 1;
+	uint16_t used = Stk_Used(id);
+
+	p = Fmt_Str(dst, e, stk_names[id], 16);
+	p = Fmt_Uint(p, e, Stk[id].size, 7, ' ');
+	if (Stk[id].base == 0)
+		p = Fmt_Str(p, e, "      ?      ?", 0);
+	else
+	{
+		p = Fmt_Uint(p, e, used, 7, ' ');
+		p = Fmt_Uint(p, e, Stk[id].free, 7, ' ');
+	}
+	*p = 0;
+	return p;
+}
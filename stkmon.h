@@ -0,0 +1,57 @@
+/**
+ * @file     stkmon.h
+ * @brief    Thread stack high-water monitor Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Needs OS_STKINIT 1 and OS_STKCHECK 1 in RTX_Conf_CM.c. RTX then
+ *           fills each thread stack with 0xCCCCCCCC when the thread is
+ *           created, and writes 0xE25A2EA5 to its lowest word. A thread
+ *           calls Stk_Register() first thing; the stack bottom is found by
+ *           searching down from there for that word. The free part is the
+ *           unbroken run of fill pattern above the bottom.
+ *
+ *           Results are in Stk[] for the debugger watch window, and
+ *           Stk_Line() formats one thread for a text dump.
+ *
+ *           Stack sizes are the worst call path of the host build
+ *           (-fcallgraph-info=su, the larger of x86-64 and i386), plus
+ *           64 B for an exception frame and the saved context, plus
+ *           25 %. Stk[] on the target shows how much of that is used.
+ *
+ */
+
+#ifndef ___STKMON_H_
+#define ___STKMON_H_
+
+#include <stdint.h>
+
+/** \brief Monitored threads */
+#define STK_MAIN						0
+#define STK_AD7715					1
+#define STK_MEASURE					2
+#define STK_IDLE						3
+#define STK_NTHREADS				4
+
+/** \brief main() stack, OS_MAINSTKSIZE * 4 in RTX_Conf_CM.c */
+#define STK_MAIN_SIZE				320
+
+/** \brief Length of a Stk_Line() result, with terminating zero */
+#define STK_LINE_LEN				48
+
+/** \brief One thread stack */
+typedef struct
+{
+	const uint32_t *base;		/*!< lowest word, 0 if not found */
+	uint16_t size;					/*!< bytes */
+	uint16_t free;					/*!< bytes never used, updated by Stk_Scan() */
+} stk_info_t;
+
+extern stk_info_t Stk[STK_NTHREADS];
+
+void Stk_Register(uint8_t id, uint16_t size);
+uint16_t Stk_Scan(uint8_t id);
+uint16_t Stk_Used(uint8_t id);
+char *Stk_Line(char *dst, uint8_t id);
+
+#endif
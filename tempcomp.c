@@ -0,0 +1,231 @@
+/**
+  ******************************************************************************
+  * @file    tempcomp.c
+  * @author  e.pavlin.si
+  * @brief   Temperature measurement (on-chip ADC + DMA) and pH compensation
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * ADC1 converts PB0 (ADC_IN8, PT1000 divider) and the internal temperature
+  * sensor (ADC_IN16) in continuous mode. DMA1 channel 1 stores the results
+  * into a circular buffer, so there is no CPU load until Temp_Update()
+  * averages the buffer.
+  *
+  * Electrode slope is proportional to absolute temperature, so the reading
+  * is rotated around the isopotential point:
+  *
+  *   pH(T) = pH_iso + (pH - pH_iso) * (273.15 + Tcal) / (273.15 + T)
+  *
+  * Tcal is the temperature the calibration points were taken at, stored
+  * with them by DoCal() (Cal_TempC10()).
+  *
+  * The factor is taken from a table built by the compiler and is recomputed
+  * only when the temperature changes. Per sample it costs one multiply.
+  *
+  */
+
+#include "stm32f0xx.h"                  // Device header
+#include "tempcomp.h"
+#include "calib.h"
+#include "pinmap.h"
+
+/** Temperature sensor calibration value at 30 deg C, VDDA = 3.3 V */
+#define TEMP_TS_CAL1			(*((uint16_t *)0x1FFFF7B8))
+/** Avg_Slope 4.3 mV/deg C = 5.337 LSB/deg C at VDDA = 3.3 V, LSB/(0.1 deg C) * 1000 */
+#define TEMP_TS_SLOPE			534
+
+/** Number of converted channels per scan (ADC_IN8, ADC_IN16) */
+#define TEMP_NCH					2
+
+
+/**
+  * Nernst slope table: 298.15 K / (273.15 K + T) in Q15, 1 deg C steps.
+  * Values are computed by the compiler, nothing is calculated at runtime.
+  */
+#define TEMP_NSF(t)		((uint16_t)((32768UL * 29815UL + (27315UL + 100UL * (t)) / 2) / (27315UL + 100UL * (t))))
+#define TEMP_NSF10(t)	TEMP_NSF(t),     TEMP_NSF((t)+1), TEMP_NSF((t)+2), TEMP_NSF((t)+3), TEMP_NSF((t)+4), \
+											TEMP_NSF((t)+5), TEMP_NSF((t)+6), TEMP_NSF((t)+7), TEMP_NSF((t)+8), TEMP_NSF((t)+9)
+
+static const uint16_t Nernst_Q15[TEMP_TAB_MAX - TEMP_TAB_MIN + 1] =
+{
+	TEMP_NSF10(0),  TEMP_NSF10(10), TEMP_NSF10(20), TEMP_NSF10(30), TEMP_NSF10(40),
+	TEMP_NSF10(50), TEMP_NSF10(60), TEMP_NSF10(70), TEMP_NSF10(80), TEMP_NSF10(90),
+	TEMP_NSF(100)
+};
+
+
+/** Local variables */
+static volatile uint16_t adc_dma[TEMP_NCH * TEMP_OVS];
+static int16_t temp_c10 = TEMP_DEFAULT_C10;
+static int16_t comp_c10 = TEMP_CAL_C10;
+static int16_t comp_cal = TEMP_CAL_C10;
+static uint8_t temp_valid;
+static uint16_t comp_q15 = 32768;      // compensation factor, Tcal/T in Q15
+
+
+/**
+  * Interpolated table value for temperature in 0.1 deg C
+  */
+static uint32_t Temp_Nernst(int16_t c10)
+{
+	uint16_t i, f;
+
+	if (c10 < TEMP_TAB_MIN * 10) c10 = TEMP_TAB_MIN * 10;
+	if (c10 >= TEMP_TAB_MAX * 10) return Nernst_Q15[TEMP_TAB_MAX - TEMP_TAB_MIN];
+	i = (uint16_t)(c10 / 10 - TEMP_TAB_MIN);
+	f = (uint16_t)(c10 % 10);
+
+	return (Nernst_Q15[i] * (10UL - f) + Nernst_Q15[i + 1] * (uint32_t)f + 5) / 10;
+}
+
+
+/**
+  * Init ADC, DMA and the PT1000 pin. ADC runs continuously afterwards.
+  */
+void Temp_Init(void)
+{
+	static const gpio_cfg_t pb = GPIO_CFG(TEMP_PINMAP, GPIO_PB);
+
+	RCC->AHBENR  |= GPIO_CLOCKS(TEMP_PINMAP); /* Enable GPIOB clock     */
+	RCC->AHBENR  |= RCC_AHBENR_DMAEN;     /* Enable DMA clock           */
+	RCC->APB2ENR |= RCC_APB2ENR_ADCEN;    /* Enable ADC clock           */
+
+	/* PT1000 pin analog, no pull */
+	Gpio_Config(GPIOB, &pb);
+
+	/* ADC kernel clock: dedicated 14 MHz HSI14 */
+	RCC->CR2 |= RCC_CR2_HSI14ON;
+	while ((RCC->CR2 & RCC_CR2_HSI14RDY) == 0);
+
+	/* Calibrate ADC (ADEN must be 0) */
+	if (ADC1->CR & ADC_CR_ADEN)
+	{
+		ADC1->CR |= ADC_CR_ADDIS;
+		while (ADC1->CR & ADC_CR_ADEN);
+	}
+	ADC1->CR |= ADC_CR_ADCAL;
+	while (ADC1->CR & ADC_CR_ADCAL);
+
+	/* Continuous scan of IN8 and IN16, longest sampling time, circular DMA */
+	ADC1->CFGR1  = ADC_CFGR1_CONT | ADC_CFGR1_DMAEN | ADC_CFGR1_DMACFG;
+	ADC1->SMPR   = ADC_SMPR_SMP;
+	ADC1->CHSELR = ADC_CHSELR_CHSEL8 | ADC_CHSELR_CHSEL16;
+	ADC->CCR    |= ADC_CCR_TSEN;
+
+	DMA1_Channel1->CCR   = 0;
+	DMA1_Channel1->CPAR  = (uint32_t)(uintptr_t)&ADC1->DR;
+	DMA1_Channel1->CMAR  = (uint32_t)(uintptr_t)adc_dma;
+	DMA1_Channel1->CNDTR = TEMP_NCH * TEMP_OVS;
+	DMA1_Channel1->CCR   = DMA_CCR_MINC | DMA_CCR_PSIZE_0 | DMA_CCR_MSIZE_0 | DMA_CCR_CIRC;
+	DMA1_Channel1->CCR  |= DMA_CCR_EN;
+
+	ADC1->CR |= ADC_CR_ADEN;
+	while ((ADC1->ISR & ADC_ISR_ADRDY) == 0);
+	ADC1->CR |= ADC_CR_ADSTART;
+}
+
+
+/**
+  * Average DMA buffer, convert to temperature and refresh compensation
+  * factor. Call periodically from thread context.
+  */
+void Temp_Update(void)
+{
+	uint32_t ext = 0, in = 0;
+	int32_t t;
+	int16_t tcal;
+	uint8_t i;
+
+	for (i = 0; i < TEMP_OVS; i++)
+	{
+		ext += adc_dma[TEMP_NCH * i];
+		in  += adc_dma[TEMP_NCH * i + 1];
+	}
+	ext /= TEMP_OVS;
+	in  /= TEMP_OVS;
+
+	temp_valid = 0;
+#if (TEMP_SOURCE == TEMP_SRC_PT1000)
+	if (ext < 4095)
+	{
+		/* R = Rref * raw / (4095 - raw), 0.1 ohm; T = (R - 1000) / 3.85 */
+		t = (int32_t)((TEMP_PT1000_RREF * 10UL * ext) / (4095UL - ext));
+		t = ((t - 10000L) * 100L) / 385L;
+		/* open, shorted or wrong divider falls back to the internal sensor */
+		temp_valid = (t >= TEMP_PT1000_MIN_C10) && (t <= TEMP_PT1000_MAX_C10);
+	}
+#endif
+	if (!temp_valid)
+	{
+		if (in != 0)
+		{
+			t = 300L + (((int32_t)TEMP_TS_CAL1 - (int32_t)in) * 1000L) / TEMP_TS_SLOPE;
+			temp_valid = 1;
+		}
+		else
+		{
+			t = TEMP_DEFAULT_C10;
+		}
+	}
+	temp_c10 = (int16_t)t;
+
+	tcal = Cal_TempC10();
+	if ((temp_c10 != comp_c10) || (tcal != comp_cal))
+	{
+		comp_c10 = temp_c10;
+		comp_cal = tcal;
+		comp_q15 = (uint16_t)((Temp_Nernst(comp_c10) << 15) / Temp_Nernst(comp_cal));
+	}
+}
+
+
+/**
+  * Last measured temperature, 0.1 deg C
+  */
+int16_t Temp_C10(void)
+{
+	return temp_c10;
+}
+
+
+uint8_t Temp_Valid(void)
+{
+	return temp_valid;
+}
+
+
+/**
+  * Apply temperature compensation to pH (0.001 pH)
+  */
+int32_t Temp_Compensate(int32_t ph)
+{
+	return TEMP_ISO_PH + (((ph - TEMP_ISO_PH) * (int32_t)comp_q15 + 16384) >> 15);
+}
@@ -0,0 +1,53 @@
+/**
+ * @file     tempcomp.h
+ * @brief    Temperature measurement and pH compensation Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note
+ *
+ */
+
+#ifndef ___TEMPCOMP_H_
+#define ___TEMPCOMP_H_
+
+#include <stdint.h>
+
+/** \brief Temperature sources */
+#define TEMP_SRC_INTERNAL		0			/*!< on-chip sensor, ADC_IN16 */
+#define TEMP_SRC_PT1000			1			/*!< PT1000 to GND, TEMP_PT1000_RREF to VDDA on PB0 (ADC_IN8) */
+
+#ifndef TEMP_SOURCE
+ #define TEMP_SOURCE				TEMP_SRC_PT1000
+#endif
+
+/** \brief PT1000 divider reference resistor, ohm */
+#define TEMP_PT1000_RREF		1000
+
+/** \brief Number of scans averaged from the DMA buffer */
+#define TEMP_OVS						8
+
+/** \brief Compensation table range, deg C (1 deg C steps, interpolated) */
+#define TEMP_TAB_MIN				0
+#define TEMP_TAB_MAX				100
+
+/** \brief Temperature of the default calibration, 0.1 deg C; DoCal() stores the measured one */
+#define TEMP_CAL_C10				250
+
+/** \brief Plausible PT1000 reading, 0.1 deg C; outside it the internal sensor is used */
+#define TEMP_PT1000_MIN_C10	-200
+#define TEMP_PT1000_MAX_C10	1200
+
+/** \brief Electrode isopotential point, 0.001 pH */
+#define TEMP_ISO_PH					7000
+
+/** \brief Temperature used when no valid sensor is found, 0.1 deg C */
+#define TEMP_DEFAULT_C10		250
+
+void Temp_Init(void);
+void Temp_Update(void);
+int16_t Temp_C10(void);
+uint8_t Temp_Valid(void);
+int32_t Temp_Compensate(int32_t ph);
+
+#endif
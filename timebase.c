@@ -0,0 +1,155 @@
+/**
+  ******************************************************************************
+  * @file    timebase.c
+  * @author  e.pavlin.si
+  * @brief   Microsecond timebase on TIM3
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * The high half of the timestamp counts TIM3 updates. A reader that finds
+  * UIF set has an overflow the interrupt did not count yet, and adds it,
+  * as Trace_Clock() does for SysTick.
+  *
+  */
+
+#include "stm32f0xx.h"                  // Device header
+#include "timebase.h"
+
+#define TB_TIM			TIM3
+#define TB_IRQn			TIM3_IRQn
+
+static volatile uint32_t tb_hi;				// counter updates, high half of Tb_Us()
+
+
+/**
+  * Start the counter. Call after SystemCoreClockUpdate(); PCLK = HCLK.
+  */
+void Tb_Init(void)
+{
+	RCC->APB1ENR |= RCC_APB1ENR_TIM3EN;
+
+	TB_TIM->CR1 = TIM_CR1_URS;             // only overflow sets UIF
+	TB_TIM->PSC = SystemCoreClock / 1000000UL - 1;
+	TB_TIM->ARR = 0xFFFF;
+	TB_TIM->CNT = 0;
+	TB_TIM->EGR = TIM_EGR_UG;              // load prescaler
+	TB_TIM->SR = 0;
+	TB_TIM->DIER = TIM_DIER_UIE;
+	tb_hi = 0;
+
+	NVIC_SetPriority(TB_IRQn, 1);
+	NVIC_EnableIRQ(TB_IRQn);
+	TB_TIM->CR1 |= TIM_CR1_CEN;
+}
+
+
+void TIM3_IRQHandler(void)
+{
+	if (TB_TIM->SR & TIM_SR_UIF)
+	{
+		TB_TIM->SR = ~TIM_SR_UIF;
+		tb_hi++;
+	}
+	if (TB_TIM->SR & TIM_SR_CC1IF)
+	{
+		TB_TIM->SR = ~TIM_SR_CC1IF;
+		TB_TIM->DIER &= ~TIM_DIER_CC1IE;       // one shot, Tb_WakeAt()
+	}
+}
+
+
+/**
+  * Microseconds since Tb_Init()
+  */
+uint32_t Tb_Us(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t hi, cnt;
+
+	__disable_irq();
+	hi = tb_hi;
+	cnt = TB_TIM->CNT;
+	if (TB_TIM->SR & TIM_SR_UIF)
+	{
+		hi++;
+		cnt = TB_TIM->CNT;
+	}
+	__set_PRIMASK(primask);
+	return (hi << 16) | (cnt & 0xFFFF);
+}
+
+
+/**
+  * Interrupt (and so wake from WFI) when Tb_Us() reaches t. Beyond one
+  * counter period the update interrupt comes first, which the sleeper
+  * takes as an early wakeup. Returns 0 if t is too close to arm.
+  */
+uint8_t Tb_WakeAt(uint32_t t)
+{
+	uint32_t d = t - Tb_Us();
+
+	if ((d < 2) || (d & 0x80000000UL)) return 0;
+	if (d < 0x10000UL)
+	{
+		TB_TIM->CCR1 = t & 0xFFFF;
+		TB_TIM->SR = ~TIM_SR_CC1IF;
+		TB_TIM->DIER |= TIM_DIER_CC1IE;
+	}
+	return 1;
+}
+
+
+/**
+  * Busy wait, at least us microseconds
+  */
+void Tb_DelayUs(uint32_t us)
+{
+	uint32_t t0 = Tb_Us();
+
+	while ((Tb_Us() - t0) <= us);
+}
+
+
+/**
+  * Tb_Spin() loops for at least ns nanoseconds at SystemCoreClock
+  */
+uint32_t Tb_NsLoops(uint32_t ns)
+{
+	uint32_t cycles = ((SystemCoreClock / 1000000UL) * ns + 999) / 1000;
+
+	return (cycles + TB_LOOP_CYCLES - 1) / TB_LOOP_CYCLES;
+}
+
+
+void Tb_Spin(uint32_t loops)
+{
+	while (loops--) __NOP();
+}
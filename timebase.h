@@ -0,0 +1,41 @@
+/**
+ * @file     timebase.h
+ * @brief    Microsecond timebase Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     TIM3 counts free running at 1 MHz, the prescaler derived from
+ *           SystemCoreClock. Its update interrupt extends the 16 bit
+ *           counter to 32 bits, so Tb_Us() is a microsecond timestamp that
+ *           wraps after 71 minutes and can be read from any context,
+ *           before the kernel starts as well.
+ *
+ *           Tb_DelayUs() waits at least the given time. Tb_WakeAt() arms a
+ *           one shot compare interrupt, the wakeup of the tickless idle
+ *           in os_idle_demon(). Tb_Spin() is for sub-microsecond bus
+ *           timing, with the loop count from Tb_NsLoops().
+ *
+ *           TB_CORE_HZ is the clock set by SystemCoreClockConfigure() and
+ *           is OS_CLOCK in RTX_Conf_CM.c.
+ *
+ */
+
+#ifndef ___TIMEBASE_H_
+#define ___TIMEBASE_H_
+
+#include <stdint.h>
+
+/** \brief Core clock: HSI / 2 * 12 */
+#define TB_CORE_HZ					48000000UL
+
+/** \brief Core clocks per Tb_Spin() loop, at least */
+#define TB_LOOP_CYCLES			4
+
+void Tb_Init(void);
+uint32_t Tb_Us(void);
+void Tb_DelayUs(uint32_t us);
+uint8_t Tb_WakeAt(uint32_t t);
+uint32_t Tb_NsLoops(uint32_t ns);
+void Tb_Spin(uint32_t loops);
+
+#endif
@@ -0,0 +1,296 @@
+/**
+  ******************************************************************************
+  * @file    titration.c
+  * @author  e.pavlin.si
+  * @brief   Titration mode: high-rate capture and endpoint detection
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * Conversions are delivered one by one from AD7715_Thread. TITR_DECIM
+  * conversions are averaged into one point, which is converted to pH and
+  * stored to the RAM ring. Derivatives are updated once per point:
+  *
+  *   d1 = IIR( dpH / dx )        x = time (points) or dosed volume
+  *   d2 = d1 - d1(previous)
+  *
+  * A steep segment is a run of points with |d1| at or above
+  * TITR_EP_MIN_SLOPE. Its point of largest |d1|, the inflection, is
+  * recorded as an endpoint when |d1| falls below the threshold again.
+  * Noise on the slope makes several local maxima within one segment, and
+  * they still give one endpoint.
+  *
+  * Point times add up the conversion intervals in us and carry the rest
+  * of every 0.1 s, so they do not drift.
+  *
+  */
+
+#include "cmsis_os.h"                   // CMSIS RTOS header file
+#include "ad7715.h"
+#include "titration.h"
+#include "measure.h"
+#include "rtmon.h"
+#include <string.h>
+
+
+/** Local variables */
+static titr_point_t ring[TITR_RING_LEN];
+static uint16_t ring_head, ring_cnt;
+
+static titr_status_t TS;
+
+static volatile uint8_t restart;       // start requested from UI thread
+static volatile uint16_t dose_vol;     // dosed volume from pump driver
+static uint8_t pump_used;
+
+static uint32_t acc;                   // conversion accumulator
+static uint8_t  acc_n;
+static uint32_t last_us;               // AD7715_SampleTime() of last conversion
+static uint32_t period_us;             // nominal conversion period
+static uint32_t t_rem_us;              // time since t_ds, us
+static uint16_t t_ds;                  // time since start, 0.1 s
+static uint32_t rate_us;               // start of the rate window
+static uint16_t rate_cnt;
+
+static titr_point_t prev_pt;
+static uint8_t  have_prev;
+static titr_endpoint_t peak;           // steepest point of the current segment
+static int16_t  peak_m;                // its |d1|, 0 outside a steep segment
+
+
+/**
+  * Clear all run state. Called from the sampling thread only.
+  */
+static void Titration_Reset(void)
+{
+	memset(&TS, 0, sizeof(TS));
+	ring_head = 0;
+	ring_cnt = 0;
+	acc = 0;
+	acc_n = 0;
+	t_rem_us = 0;
+	t_ds = 0;
+	rate_cnt = 0;
+	have_prev = 0;
+	peak_m = 0;
+	pump_used = 0;
+	dose_vol = 0;
+	prev_pt.vol = 0;
+	period_us = 1000000UL / TITR_FS_HZ;
+	Rt_Declare(RT_JOB_CTRL, TITR_DECIM * period_us, TITR_DECIM * period_us);
+	last_us = AD7715_SampleTime();
+	rate_us = last_us;
+	TS.active = 1;
+}
+
+
+/**
+  * Update derivatives with a new point and check for an endpoint
+  */
+static void Titration_Derive(const titr_point_t *pt)
+{
+	int32_t dp, dx, d, m;
+
+	if (!have_prev)
+	{
+		have_prev = 1;
+		prev_pt = *pt;
+		return;
+	}
+
+	dp = (int32_t)pt->ph - (int32_t)prev_pt.ph;
+	if (pump_used)
+	{
+		dx = (int32_t)pt->vol - (int32_t)prev_pt.vol;
+		if (dx <= 0) return;                // no titrant added, no new information
+	}
+	else
+	{
+		dx = 1;
+	}
+	prev_pt = *pt;
+
+	/* smoothed 1st derivative: d1 += (dp/dx - d1) / 4 */
+	d = (dp << TITR_D_SHIFT) / dx;
+	d = TS.d1 + ((d - TS.d1) >> 2);
+	if (d > 32767) d = 32767;
+	if (d < -32767) d = -32767;
+	TS.d2 = (int16_t)(d - TS.d1);
+	TS.d1 = (int16_t)d;
+
+	/* maximum of |d1| within a steep segment is the inflection point */
+	m = (d < 0) ? -d : d;
+	if (m >= TITR_EP_MIN_SLOPE)
+	{
+		if (m > peak_m)
+		{
+			peak_m = (int16_t)m;
+			peak.t = pt->t;
+			peak.ph = pt->ph;
+			peak.vol = pt->vol;
+			peak.slope = (int16_t)d;
+		}
+	}
+	else if (peak_m)
+	{
+		if (TS.n_ep < TITR_MAX_EP) TS.ep[TS.n_ep++] = peak;
+		peak_m = 0;
+	}
+}
+
+
+/**
+  * Start titration run: raise AD7715 output rate and clear the capture
+  */
+void Titration_Start(void)
+{
+	AD7715_SetRate(TITR_FS);
+	restart = 1;
+}
+
+
+/**
+  * Stop titration run and return AD7715 to the normal measurement rate
+  */
+void Titration_Stop(void)
+{
+	restart = 0;
+	TS.active = 0;
+	AD7715_SetRate(AD7715_MainsRate());
+}
+
+
+uint8_t Titration_Active(void)
+{
+	return (TS.active | restart);
+}
+
+
+/**
+  * Report dosed volume (0.01 ml) from the pump driver. Once called, the
+  * derivatives are taken with respect to volume instead of time.
+  */
+void Titration_Dose(uint16_t vol)
+{
+	dose_vol = vol;
+	pump_used = 1;
+}
+
+
+/**
+  * Feed one raw conversion. Called from AD7715_Thread for each conversion
+  * while titration is active.
+  */
+void Titration_Sample(uint16_t code)
+{
+	uint32_t now, dt;
+	titr_point_t *pt;
+
+	if (restart)
+	{
+		restart = 0;
+		Titration_Reset();
+		return;
+	}
+	if (!TS.active) return;
+
+	/* timing: elapsed time, missed conversions and measured rate */
+	now = AD7715_SampleTime();
+	dt = now - last_us;
+	last_us = now;
+	if (dt > period_us + (period_us >> 1))
+	{
+		TS.dropped += (dt + (period_us >> 1)) / period_us - 1;
+	}
+	t_rem_us += dt;
+	while (t_rem_us >= 100000UL)
+	{
+		t_rem_us -= 100000UL;
+		t_ds++;
+	}
+	TS.samples++;
+	rate_cnt++;
+	if ((now - rate_us) >= 1000000UL)
+	{
+		TS.rate_hz = rate_cnt;
+		rate_cnt = 0;
+		rate_us = now;
+	}
+
+	/* decimate into points */
+	acc += code;
+	if (++acc_n < TITR_DECIM) return;
+
+	Rt_Start(RT_JOB_CTRL, now);
+	pt = &ring[ring_head];
+	pt->t = t_ds;
+	pt->ph = (uint16_t)((M_pH(((acc << AD7715_FRAC) + TITR_DECIM / 2) / TITR_DECIM) + 5) / 10);
+	pt->vol = dose_vol;
+	acc = 0;
+	acc_n = 0;
+
+	if (++ring_head >= TITR_RING_LEN) ring_head = 0;
+	if (ring_cnt < TITR_RING_LEN) ring_cnt++;
+	TS.points++;
+
+	Titration_Derive(pt);
+	Rt_End(RT_JOB_CTRL);
+}
+
+
+const titr_status_t *Titration_Status(void)
+{
+	return &TS;
+}
+
+
+/**
+  * Number of points currently held in the ring
+  */
+uint16_t Titration_Points(void)
+{
+	return ring_cnt;
+}
+
+
+/**
+  * Get a point from the ring, age 0 is the newest.
+  * Returns 0 if there is no such point.
+  */
+uint8_t Titration_GetPoint(uint16_t age, titr_point_t *pt)
+{
+	int16_t i;
+
+	if (age >= ring_cnt) return 0;
+	i = (int16_t)ring_head - 1 - (int16_t)age;
+	if (i < 0) i += TITR_RING_LEN;
+	*pt = ring[i];
+	return 1;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file     titration.h
+ * @brief    Titration capture and endpoint detection Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note
+ *
+ */
+
+#ifndef ___TITRATION_H_
+#define ___TITRATION_H_
+
+#include <stdint.h>
+
+/** \brief AD7715 output rate used during titration (2.4576MHz clock) */
+#define TITR_FS						AD7715_FS_250HZ
+#define TITR_FS_HZ				250
+
+/** \brief Number of conversions averaged into one titration point.
+    250 Hz / 25 = 10 points per second */
+#define TITR_DECIM				25
+
+/** \brief Number of points kept in the RAM ring (6 bytes each) */
+#define TITR_RING_LEN			96
+
+/** \brief Max. number of endpoints remembered per run */
+#define TITR_MAX_EP				4
+
+/** \brief Minimum |dpH/dx| for a steep segment, whose steepest point is
+    an endpoint: 0.02 pH per point, or per 0.01 ml with a volume (pH in
+    0.01 pH units, Q.TITR_D_SHIFT) */
+#define TITR_EP_MIN_SLOPE	(2 << TITR_D_SHIFT)
+
+/** \brief Fractional bits of the smoothed derivatives */
+#define TITR_D_SHIFT			4
+
+
+/** \brief One captured titration point */
+typedef struct
+{
+	uint16_t t;				/*!< time since start, 0.1 s */
+	uint16_t ph;			/*!< pH * 100 */
+	uint16_t vol;			/*!< dosed volume, 0.01 ml */
+} titr_point_t;
+
+
+/** \brief Detected endpoint (inflection of the titration curve) */
+typedef struct
+{
+	uint16_t t;				/*!< time since start, 0.1 s */
+	uint16_t ph;			/*!< pH * 100 */
+	uint16_t vol;			/*!< dosed volume, 0.01 ml */
+	int16_t  slope;		/*!< smoothed dpH/dx at the endpoint, Q.TITR_D_SHIFT */
+} titr_endpoint_t;
+
+
+/** \brief Titration run status */
+typedef struct
+{
+	uint8_t  active;
+	uint8_t  n_ep;						/*!< number of valid entries in ep[] */
+	uint16_t rate_hz;					/*!< measured conversion rate */
+	uint32_t samples;					/*!< conversions captured */
+	uint32_t dropped;					/*!< conversions missed (late polling) */
+	uint32_t points;					/*!< points produced (ring may hold less) */
+	int16_t  d1;							/*!< smoothed 1st derivative, Q.TITR_D_SHIFT */
+	int16_t  d2;							/*!< 2nd derivative, Q.TITR_D_SHIFT */
+	titr_endpoint_t ep[TITR_MAX_EP];
+} titr_status_t;
+
+
+void Titration_Start(void);
+void Titration_Stop(void);
+uint8_t Titration_Active(void);
+void Titration_Sample(uint16_t code);
+void Titration_Dose(uint16_t vol);
+const titr_status_t *Titration_Status(void);
+uint16_t Titration_Points(void);
+uint8_t Titration_GetPoint(uint16_t age, titr_point_t *pt);
+
+#endif
@@ -0,0 +1,214 @@
+/**
+  ******************************************************************************
+  * @file    trace.c
+  * @author  e.pavlin.si
+  * @brief   Event trace ring
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * Cortex-M0 has no LDREX/STREX, so a writer reserves its slot and fills
+  * it with interrupts masked. That is a few instructions and no kernel
+  * call, so any ISR and any thread can trace without a mutex. The oldest
+  * records are overwritten.
+  *
+  * The timestamp is Tb_Us(). SysTick would not do: the tickless idle
+  * masks it while the core sleeps, and os_resume() catches os_time up
+  * only after the interrupt that woke the core has run, so an encoder
+  * edge would be stamped early by the whole sleep. TIM3 keeps counting
+  * in sleep.
+  *
+  */
+
+#include "stm32f0xx.h"                  // Device header
+#include "trace.h"
+#include "timebase.h"
+
+#ifdef TRACE
+
+/** Back to back events timed by Trace_Init() */
+#define TRACE_CAL_N		16
+
+/** The ring, for the debugger */
+trace_buf_t Trace;
+
+/** Encoder to display latency, for the debugger */
+trace_lat_t TraceLat;
+
+
+/**
+  * Microseconds since Tb_Init()
+  */
+uint32_t Trace_Now(void)
+{
+	return Tb_Us();
+}
+
+
+/**
+  * Histogram bin of d us: d is shifted right s times until TRACE_LAT_SUB + 1
+  * bits are left, the bin is s * 2^TRACE_LAT_SUB plus those bits
+  */
+static uint32_t Trace_LatBin(uint32_t d)
+{
+	uint32_t s = 0;
+
+	while (d >= (2UL << TRACE_LAT_SUB))
+	{
+		d >>= 1;
+		s++;
+	}
+	if (s > TRACE_LAT_OCT) return TRACE_LAT_BINS - 1;
+	return (s << TRACE_LAT_SUB) + d;
+}
+
+
+/**
+  * Largest latency in us that falls into bin b
+  */
+static uint32_t Trace_LatEdge(uint32_t b)
+{
+	uint32_t s = (b < (2UL << TRACE_LAT_SUB)) ? 0 : (b >> TRACE_LAT_SUB) - 1;
+
+	return ((b - (s << TRACE_LAT_SUB) + 1) << s) - 1;
+}
+
+
+/**
+  * Close or open a latency measurement. Called with interrupts masked.
+  */
+static void Trace_Latency(uint8_t id, uint32_t t)
+{
+	trace_lat_t *l = &TraceLat;
+	uint32_t d, b;
+
+	if ((id == TRC_ENC_STEP) || (id == TRC_ENC_KEY))
+	{
+		if (!l->pending) l->t0 = t;
+		l->pending = 1;
+	}
+	else if ((id == TRC_LCD_DONE) && l->pending)
+	{
+		l->pending = 0;
+		d = t - l->t0;
+		b = Trace_LatBin(d);
+		if (l->bin[b] < 0xFFFF) l->bin[b]++;
+		l->count++;
+		l->sum += d;
+		l->last = d;
+		if (d < l->min) l->min = d;
+		if (d > l->max) l->max = d;
+	}
+}
+
+
+void Trace_Event(uint8_t id, uint16_t arg)
+{
+	uint32_t primask = __get_PRIMASK();
+	trace_rec_t *r;
+	uint32_t n;
+
+	__disable_irq();
+	n = Trace.head++;
+	r = &Trace.rec[n & (TRACE_LEN - 1)];
+	r->t = Tb_Us();
+	r->arg = arg;
+	r->id = id;
+	r->seq = (uint8_t)n;
+	Trace_Latency(id, r->t);
+	__set_PRIMASK(primask);
+}
+
+
+void Trace_LatReset(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint8_t i;
+
+	__disable_irq();
+	TraceLat.count = 0;
+	TraceLat.min = 0xFFFFFFFF;
+	TraceLat.max = 0;
+	TraceLat.sum = 0;
+	TraceLat.last = 0;
+	TraceLat.pending = 0;
+	for (i = 0; i < TRACE_LAT_BINS; i++) TraceLat.bin[i] = 0;
+	__set_PRIMASK(primask);
+}
+
+
+/**
+  * Latency in us that pct percent of the measurements do not exceed:
+  * upper edge of the histogram bin, but not more than the maximum.
+  * Below 2^(TRACE_LAT_SUB + 1) us it is exact, above it up to
+  * 2^-TRACE_LAT_SUB too high.
+  * 0 before the first measurement.
+  */
+uint32_t Trace_LatPct(uint8_t pct)
+{
+	uint32_t need, sum = 0, edge;
+	uint16_t i;
+
+	if (TraceLat.count == 0) return 0;
+	need = (TraceLat.count * pct + 99) / 100;
+	if (need == 0) need = 1;
+	for (i = 0; i < TRACE_LAT_BINS - 1; i++)
+	{
+		sum += TraceLat.bin[i];
+		if (sum >= need) break;
+	}
+	edge = Trace_LatEdge(i);
+	return ((i == TRACE_LAT_BINS - 1) || (edge > TraceLat.max)) ? TraceLat.max : edge;
+}
+
+
+/**
+  * Clear the ring and measure the cost of one event: the spacing of
+  * back to back records, in ns from a run of TRACE_CAL_N of them, since
+  * one is shorter than a microsecond. Call after osKernelStart().
+  */
+void Trace_Init(void)
+{
+	uint32_t d;
+	uint8_t i;
+
+	Trace.magic = 0;
+	Trace.len = TRACE_LEN;
+	Trace.hz = 1000000UL;
+	Trace.head = 0;
+	for (i = 0; i < TRACE_CAL_N; i++) Trace_Event(TRC_NONE, 0);
+	d = Trace.rec[TRACE_CAL_N - 1].t - Trace.rec[0].t;
+	Trace.overhead = (uint16_t)(d * 1000UL / (TRACE_CAL_N - 1));
+	Trace.head = 0;
+	Trace.magic = TRACE_MAGIC;
+	Trace_LatReset();
+}
+
+#endif
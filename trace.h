@@ -0,0 +1,114 @@
+/**
+ * @file     trace.h
+ * @brief    Event trace ring Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     Fixed size records (timestamp, event, argument) in a RAM ring,
+ *           written from interrupts and threads. The ring is one structure
+ *           with a magic word, so a raw memory dump taken by the debugger
+ *           can be decoded on the host (host/tools/tracedump).
+ *
+ *           Timestamps are Tb_Us() microseconds, from TIM3, which counts
+ *           on while the tickless idle sleeps. They are readable from any
+ *           context, which osKernelSysTick() is not.
+ *
+ *           The same events give the encoder to display latency: from the
+ *           first encoder edge (TRC_ENC_STEP, TRC_ENC_KEY) not yet shown
+ *           to the next TRC_LCD_DONE. Every pair goes into TraceLat, a
+ *           histogram the ring would be too short for; Trace_LatPct()
+ *           reads percentiles from it.
+ *
+ *           TRACE_EVT compiles to nothing unless TRACE is defined.
+ *
+ */
+
+#ifndef ___TRACE_H_
+#define ___TRACE_H_
+
+#include <stdint.h>
+
+/** \brief Trace events */
+#define TRC_NONE						0
+#define TRC_ENC_STEP				1			/*!< encoder ISR, arg: 1 up, 0 down */
+#define TRC_ENC_KEY					2			/*!< key ISR */
+#define TRC_AD_SAMPLE				3			/*!< conversion read, arg: code */
+#define TRC_MENU_EVENT			4			/*!< Measure_Thread got events, arg: signals */
+#define TRC_MENU_STATE			5			/*!< Measure_Thread state, arg: new state */
+#define TRC_MARK						6			/*!< free use, arg: any */
+#define TRC_LCD_DONE				7			/*!< display redrawn after events, arg: state or value */
+#define TRC_AD_SETTLED			8			/*!< first settled readout, arg: ms from Tb_Init() */
+#define TRC_BOOT_READY			9			/*!< first settled pH shown, arg: ms from Tb_Init() */
+#define TRC_HUM							10		/*!< hum check done, arg: hum at the chosen notch, codes Q16.8 */
+
+/** \brief Records in the ring, power of 2 */
+#define TRACE_LEN						32
+
+/** \brief Latency histogram, log-linear: every octave of us is split into
+ *         2^TRACE_LAT_SUB bins, a bin is at most 2^-TRACE_LAT_SUB of its
+ *         value wide.
+ *         Below 2^(TRACE_LAT_SUB + 1) us the bins are 1 us. The last bin
+ *         also takes everything above 2^(TRACE_LAT_OCT + TRACE_LAT_SUB + 1) us. */
+#define TRACE_LAT_SUB				3
+#define TRACE_LAT_OCT				12
+#define TRACE_LAT_BINS			((TRACE_LAT_OCT + 2) << TRACE_LAT_SUB)
+
+/** \brief 'TRC2' */
+#define TRACE_MAGIC					0x32435254UL
+
+/** \brief One record, 8 bytes */
+typedef struct
+{
+	uint32_t t;							/*!< Tb_Us() */
+	uint16_t arg;
+	uint8_t id;
+	uint8_t seq;						/*!< low byte of the record number */
+} trace_rec_t;
+
+/** \brief The ring, as found in a memory dump */
+typedef struct
+{
+	uint32_t magic;
+	uint16_t len;						/*!< TRACE_LEN */
+	uint16_t overhead;			/*!< ns per Trace_Event() */
+	uint32_t head;					/*!< records written since Trace_Init() */
+	uint32_t hz;						/*!< timestamp clock */
+	trace_rec_t rec[TRACE_LEN];
+} trace_buf_t;
+
+/** \brief Encoder to display latency, us */
+typedef struct
+{
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t last;					/*!< latest measurement */
+	uint32_t t0;						/*!< first edge not yet shown */
+	uint8_t pending;				/*!< t0 is valid */
+	uint16_t bin[TRACE_LAT_BINS];
+} trace_lat_t;
+
+
+#ifdef TRACE
+
+extern trace_buf_t Trace;
+extern trace_lat_t TraceLat;
+
+void Trace_Init(void);
+void Trace_Event(uint8_t id, uint16_t arg);
+uint32_t Trace_Now(void);
+void Trace_LatReset(void);
+uint32_t Trace_LatPct(uint8_t pct);
+
+#define TRACE_INIT()				Trace_Init()
+#define TRACE_EVT(id, arg)	Trace_Event((id), (uint16_t)(arg))
+
+#else
+
+#define TRACE_INIT()				((void)0)
+#define TRACE_EVT(id, arg)	((void)0)
+
+#endif
+
+#endif
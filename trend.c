@@ -0,0 +1,190 @@
+/**
+  ******************************************************************************
+  * @file    trend.c
+  * @author  e.pavlin.si
+  * @brief   pH trend graph
+  ******************************************************************************
+  * @attention
+  * <h2><center>http://e.pavlin.si</center></h2>
+  *
+  * This is free and unencumbered software released into the public domain.
+  *
+  * Anyone is free to copy, modify, publish, use, compile, sell, or
+  * distribute this software, either in source code form or as a compiled
+  * binary, for any purpose, commercial or non-commercial, and by any
+  * means.
+  *
+  * In  jurisdictions that recognize copyright laws, the author or authors
+  * of this software dedicate any and all copyright interest in the
+  * software to the public domain. We make this dedication for the benefit
+  * of the public at large and to the detriment of our heirs and
+  * successors. We intend this dedication to be an overt act of
+  * relinquishment in perpetuity of all present and future rights to this
+  * software under copyright law.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+  * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+  * OTHER DEALINGS IN THE SOFTWARE.
+
+  * For more information, please refer to <http://unlicense.org>
+  *
+  ******************************************************************************
+  *
+  * hist[] is indexed by column: the next point goes to column next, the
+  * previous one is at next - 1. The points are written by main() and read
+  * by Measure_Thread, which preempts it. A point is stored before next
+  * moves past it, so a half done Trend_Sample() only hides the new point
+  * until the next redraw.
+  *
+  * The scale is a step per dot from 1-2-5 steps of 0.001 pH, with the
+  * bottom a multiple of it, so a bar is 1 to 8 dots high. It is kept
+  * while all points fit in it and no smaller step would, so a new point
+  * does not redraw the graph unless the scale has to change.
+  *
+  */
+
+#include "stm32f0xx.h"                  // Device header
+#include "trend.h"
+#include "lcd.h"
+#include "fmt.h"
+#include <string.h>
+
+/** Bit of graph column c in a glyph row */
+#define TREND_BIT(c)			(0x10 >> ((c) % 5))
+
+/** Steps per dot, 0.001 pH */
+static const uint16_t trend_steps[] = { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000 };
+#define TREND_NSTEPS			(sizeof(trend_steps) / sizeof(trend_steps[0]))
+
+/** Local variables */
+static uint16_t hist[TREND_COLS];                   // points, 0.001 pH
+static volatile uint8_t next;                       // column of the next point
+static volatile uint8_t points;                     // points so far, up to TREND_COLS - 1
+static uint32_t acc;                                // samples of the point in progress
+static uint8_t acc_n;
+static uint8_t cg[8][8];                            // glyph rows as on the display
+static uint8_t drawn;                               // cg[] and the glyph cells are valid
+static uint16_t lo, step;                           // scale, 0.001 pH
+
+
+/**
+  * Add a once a second pH sample, 0.001 pH
+  */
+void Trend_Sample(uint16_t ph)
+{
+	uint8_t c = next;
+
+	acc += ph;
+	if (++acc_n < TREND_POINT_S) return;
+
+	hist[c] = (uint16_t)((acc + TREND_POINT_S / 2) / TREND_POINT_S);
+	acc = 0;
+	acc_n = 0;
+	__DMB();
+	next = (c + 1 < TREND_COLS) ? c + 1 : 0;
+	if (points < TREND_COLS - 1) points++;
+}
+
+
+/**
+  * Write the whole graph on the next Trend_Draw(); the screen was used
+  * for something else
+  */
+void Trend_Invalidate(void)
+{
+	drawn = 0;
+}
+
+
+/**
+  * Pick the scale for points between min and max: the current one while
+  * it fits and no smaller step does. Returns 1 if it changed.
+  */
+static uint8_t Trend_Scale(uint16_t min, uint16_t max)
+{
+	uint16_t s, b;
+	uint8_t i;
+
+	for (i = 0; i < TREND_NSTEPS - 1; i++)
+	{
+		s = trend_steps[i];
+		b = min - min % s;
+		if (max < b + 8 * s) break;
+	}
+	s = trend_steps[i];
+	b = min - min % s;
+
+	if (step && (s >= step) && (min >= lo) && (max < lo + 8 * step)) return 0;
+	step = s;
+	lo = b;
+	return 1;
+}
+
+
+/**
+  * Draw the trend on the second line: the full height of the graph in pH
+  * left of it, the bars in the glyphs
+  */
+void Trend_Draw(void)
+{
+	uint8_t h[TREND_COLS], rows[8];
+	uint16_t min = 0xFFFF, max = 0, v;
+	uint8_t c, n, g, r, first, last, age, rescaled = 0;
+	char str[17], *p, *e = str + TREND_X;
+
+	n = points;
+	c = next;
+	memset(h, 0, sizeof(h));
+	for (age = 1; age <= n; age++)
+	{
+		c = (c ? c : TREND_COLS) - 1;
+		v = hist[c];
+		if (v < min) min = v;
+		if (v > max) max = v;
+	}
+	if (n) rescaled = Trend_Scale(min, max);
+	for (age = 1, c = next; age <= n; age++)
+	{
+		c = (c ? c : TREND_COLS) - 1;
+		h[c] = (uint8_t)((hist[c] - lo) / step + 1);
+	}
+
+	/* glyph rows, top row first; write those that changed in one run */
+	for (g = 0; g < 8; g++)
+	{
+		first = 8;
+		last = 0;
+		for (r = 0; r < 8; r++)
+		{
+			rows[r] = 0;
+			for (c = 5 * g; c < 5 * g + 5; c++)
+				if (h[c] >= 8 - r) rows[r] |= TREND_BIT(c);
+			if (!drawn || (rows[r] != cg[g][r]))
+			{
+				if (first == 8) first = r;
+				last = r;
+			}
+		}
+		if (first == 8) continue;
+		LCD_SetCharRows(g, first, last - first + 1, &rows[first]);
+		memcpy(&cg[g][first], &rows[first], last - first + 1);
+	}
+
+	if (!drawn || rescaled)
+	{
+		p = str;
+		if (n)
+		{
+			p = Fmt_Fixed(p, e, 8 * step, 3, 0);
+			p = Fmt_Str(p, e, "pH", 0);
+		}
+		LCD_Puts(0, 1, Fmt_Fill(str, p, TREND_X));
+	}
+	if (!drawn)
+		for (g = 0; g < 8; g++) LCD_PutCustom(TREND_X + g, 1, g);
+	drawn = 1;
+}
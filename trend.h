@@ -0,0 +1,38 @@
+/**
+ * @file     trend.h
+ * @brief    pH trend graph Header File
+ * @version  V0.00
+ * @date     18. October 2026
+ * @copyrigt s54mtb
+ * @note     The trend job (sched.h) samples the pH once a second and
+ *           Trend_Sample() averages TREND_POINT_S of them into one point of
+ *           the history. Its TREND_COLS points are the pixel columns of the
+ *           8 CGRAM glyphs, placed at TREND_X on the second line.
+ *
+ *           Trend_Draw() shows the points as bars. The graph sweeps: a new
+ *           point takes the column of the oldest one and the column after
+ *           it stays blank, so a point changes two columns and the other
+ *           glyphs stay as they are. Only the CGRAM rows that differ from
+ *           what was written before go to the display.
+ *
+ */
+
+#ifndef ___TREND_H_
+#define ___TREND_H_
+
+#include <stdint.h>
+
+/** \brief Seconds per point; TREND_COLS - 1 points shown, 10 minutes */
+#define TREND_POINT_S				15
+
+/** \brief Points kept, pixel columns of 8 glyphs 5 dots wide */
+#define TREND_COLS					40
+
+/** \brief Display column of the first glyph, second line */
+#define TREND_X							8
+
+void Trend_Sample(uint16_t ph);
+void Trend_Invalidate(void);
+void Trend_Draw(void);
+
+#endif